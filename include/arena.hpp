@@ -0,0 +1,105 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cassert>
+
+namespace arena{
+
+    /// @brief View of objects that live inside an arena
+    template<typename T>
+    class Span {
+    public:
+        Span() = default;
+        Span(T* data, const std::size_t count) : data(data), count(count) {}
+
+        std::size_t size() const { return count; }
+        bool empty() const { return !count; }
+        T& front() const { assert(count); return *data; }
+        T& operator[](const std::size_t index) const { assert(index < count); return data[index]; }
+        T* begin() const { return data; }
+        T* end() const { return data + count; }
+
+    private:
+        T* data{nullptr};
+        std::size_t count{0};
+    };
+
+    /// @brief Bump allocator with stack-like release semantics.
+    /// Memory is taken from large blocks that are kept after a release,
+    /// so once the blocks are allocated the global allocator is not used anymore.
+    class Arena {
+    public:
+        // position in the arena that everything allocated afterwards can be released to
+        struct Marker{
+            std::size_t block{0};
+            std::size_t offset{0};
+        };
+
+        /// @brief Releases everything allocated in its lifetime when it goes out of scope
+        class Scope {
+        public:
+            explicit Scope(Arena& arena) : arena(arena), marker(arena.getMarker()) {}
+            ~Scope() { arena.release(marker); }
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+            Arena& getArena() const { return arena; }
+
+        private:
+            Arena& arena;
+            const Marker marker;
+        };
+
+        static constexpr std::size_t DEFAULT_BLOCK_SIZE{64 * 1024};
+
+        explicit Arena(const std::size_t block_size = DEFAULT_BLOCK_SIZE) : block_size(block_size) {}
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        /// @brief Arena of the calling thread
+        static Arena& local();
+
+        void* allocate(const std::size_t bytes, const std::size_t alignment) {
+            std::size_t aligned_offset = (offset + alignment - 1) & ~(alignment - 1);
+            if(current_block >= blocks.size() || aligned_offset + bytes > blocks[current_block].size) {
+                nextBlock(bytes + alignment);
+                aligned_offset = 0;
+            }
+            offset = aligned_offset + bytes;
+            return blocks[current_block].memory.get() + aligned_offset;
+        }
+
+        /// @brief Reserves uninitialized memory for count objects
+        template<typename T>
+        T* allocate(const std::size_t count) {
+            return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+        }
+
+        Marker getMarker() const { return {current_block, offset}; }
+
+        /// @brief Frees everything allocated after the marker was taken
+        void release(const Marker& marker) {
+            assert(marker.block < current_block || (marker.block == current_block && marker.offset <= offset));
+            current_block = marker.block;
+            offset = marker.offset;
+        }
+
+        /// @brief Number of blocks that were requested from the global allocator
+        std::size_t getBlockCount() const { return blocks.size(); }
+
+    private:
+        struct Block{
+            std::unique_ptr<std::byte[]> memory;
+            std::size_t size;
+        };
+
+        void nextBlock(const std::size_t min_bytes);
+
+        std::vector<Block> blocks;
+        std::size_t block_size;
+        std::size_t current_block{0};
+        std::size_t offset{0};
+    };
+}
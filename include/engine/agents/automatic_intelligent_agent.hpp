@@ -1,5 +1,6 @@
 #pragma once
 #include "engine/agents/intelligent_agent.hpp"
+#include <cstddef>
 
 namespace engine{
     class AutomaticIntelligentAgent : public IntelligentAgent {
@@ -9,11 +10,14 @@ namespace engine{
         using StateMachine = IntelligentAgent::StateMachine;
         using Search = IntelligentAgent::Search;
 
-        AutomaticIntelligentAgent(const double time_limit = parameters::TIME_LIMIT, const bool activate_logging = false) {this->logging = activate_logging; this->time_limit = time_limit;}
+        AutomaticIntelligentAgent(const search::SearchLimits& limits = {}, const bool activate_logging = false) {this->logging = activate_logging; this->limits = limits;}
         State getSuccessor(State state, std::vector<std::unique_ptr<State>> children) override;
         void confirm() const override { return; }
         void reset() override{ last_result = {}; }
 
         bool logging{false};
+        // number of searches and the seconds they took, e.g. to compare search settings in simulations
+        std::size_t search_count{0};
+        double search_seconds{0.0};
     };
 }
\ No newline at end of file
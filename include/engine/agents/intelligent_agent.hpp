@@ -14,11 +14,15 @@ namespace engine{
         using State = engine::State;
         using Evaluator = engine::Evaluator;
         using StateMachine = engine::StateMachine;
-        using Search = search::ThreadedSearch<search::IterativeSearch<search::TranspositionSearch<StateMachine, Evaluator>>>;
+        // the iterations at the root stop once the choice is stable, the leaves of the threaded search deepen on their own
+        using Search = search::IterativeSearch<search::ThreadedSearch<search::IterativeSearch<search::TranspositionSearch<StateMachine, Evaluator>>>, false, true>;
 
     protected:
         Search::Result last_result{};
-        double time_limit{parameters::TIME_LIMIT};
-        Search::Result getBestChoice(const State& state, const bool logging) const;
+        search::SearchLimits limits{};
+
+        /// @brief Searches the best choice
+        /// @param limits time and node limits of this search
+        Search::Result getBestChoice(const State& state, const bool logging, const search::SearchLimits& limits) const;
     };
 }
\ No newline at end of file
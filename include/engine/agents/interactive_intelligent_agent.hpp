@@ -6,7 +6,7 @@ namespace engine{
 
     class InteractiveIntelligentAgent : private IntelligentAgent, public InteractiveAgent {
     public:
-        InteractiveIntelligentAgent(const double time_limit = parameters::TIME_LIMIT) {this->time_limit = time_limit;}
+        InteractiveIntelligentAgent(const search::SearchLimits& limits = {}) {this->limits = limits;}
         State getSuccessor(State state, std::vector<std::unique_ptr<State>> children) override;
         void reset() override{ last_result = {}; }
     };
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <optional>
+#include "engine/objects/state.hpp"
+#include "engine/game_parameters.hpp"
+
+namespace engine{
+
+    /// @brief Exact scores of all decisions without items and without revealed rounds.
+    /// Once neither participant holds items nothing can be learned about the rounds anymore, so the rest of the stage
+    /// only depends on lives, live and blank rounds, sawed off shotgun, handcuffs and the side to move.
+    /// All of these states are solved by expectiminimax over the moves of the state machine when the program starts.
+    class EndgameTable {
+    public:
+        /// @brief Looks up the exact score of a state
+        /// @param state State to evaluate
+        /// @return Score of the rest of the stage, empty if the state has to be searched
+        static std::optional<double> probe(const State& state) {
+            if(!isCovered(state)) return std::nullopt;
+            return table.scores[getIndex(state)];
+        }
+
+        /// @brief Checks whether the table holds the score of a state
+        /// @param state State to check
+        /// @return True for unfinished decisions without items, revealed rounds and pending inverter
+        static bool isCovered(const State& state) {
+            if(state.next_event.action != Action::Evaluating || state.inverter_used) return false;
+            if(!state.player.items.empty() || !state.dealer.items.empty()) return false;
+            if(!state.player.lives || !state.dealer.lives || !state.shotgun.getRemainingRounds()) return false;
+            if(state.player.lives > game_parameters::MAX_LIVES || state.dealer.lives > game_parameters::MAX_LIVES) return false;
+            const auto& shotgun = state.shotgun;
+            return !(shotgun.known_mask | shotgun.player_knowledge_mask | shotgun.dealer_knowledge_mask | shotgun.possible_dealer_knowledge_mask);
+        }
+
+    private:
+        static constexpr std::size_t SHELL_RANGE{game_parameters::MAX_SHELLS + 1};
+        static constexpr std::size_t HANDCUFF_TYPES{3};
+        static constexpr std::size_t SIZE{game_parameters::MAX_LIVES * game_parameters::MAX_LIVES * SHELL_RANGE * SHELL_RANGE * 2 * HANDCUFF_TYPES * 2};
+
+        EndgameTable();
+
+        static std::size_t getIndex(const State& state) {
+            std::size_t index = state.player.lives - 1u;
+            index = index * game_parameters::MAX_LIVES + (state.dealer.lives - 1u);
+            index = index * SHELL_RANGE + state.shotgun.getRemainingLiveRounds();
+            index = index * SHELL_RANGE + state.shotgun.getRemainingBlankRounds();
+            index = index * 2 + state.next_event.is_player_turn;
+            index = index * HANDCUFF_TYPES + state.handcuffs.getType();
+            return index * 2 + state.shotgun.isSawedOff();
+        }
+
+        /// @brief Scores a state by searching its children, children in the table must already be solved
+        double solve(const State& state) const;
+
+        /// @brief Scores a child, from the table if it is covered
+        double getScore(const State& state) const;
+
+        std::vector<double> scores;
+
+        // solved once when the program starts, the state machine and the evaluator only use constant tables
+        static const EndgameTable table;
+    };
+}
@@ -2,6 +2,9 @@
 
 #include "engine/objects/state.hpp"
 #include "engine/game_parameters.hpp"
+#include "engine/endgame_table.hpp"
+#include <algorithm>
+#include <optional>
 
 namespace engine{
     class SimpleEvaluator{
@@ -21,6 +24,10 @@ namespace engine{
         static double getWinProbability(const double score){
             return score;
         }
+
+        // hard bounds of getScore
+        static constexpr double MIN_SCORE{0.0};
+        static constexpr double MAX_SCORE{1.0};
     };
 
     class Evaluator{
@@ -30,6 +37,11 @@ namespace engine{
         /// @return Value in range (0.0, 1.0) is non-winning state. <=0.0 indicates losing. >= 1.0 indicates winning.
         static double getScore(const State& state);
 
+        /// @brief Returns the exact score of states whose stage is already solved, searches use it instead of searching them
+        /// @param state State to evaluate
+        /// @return Exact score, empty if the state has to be searched
+        static std::optional<double> getExactScore(const State& state) { return EndgameTable::probe(state); }
+
         /// @brief Converts the score value to win probability
         /// @param score 
         /// @return probability in [0.0, 1.0]
@@ -61,5 +73,14 @@ namespace engine{
         // estimate for the probability of an empty slot to be replaced by a drawn item
         // this is not how it works but assuming this simplifies the evaluation functions A LOT!
         static constexpr double ITEM_DRAW_PROBABILITY_FOR_EMPTY_SLOT{0.5};
+
+    public:
+        // hard bounds of getScore: a lost game is scored flat, a won game adds the advantage of full item slots
+        static constexpr double MIN_SCORE{LOSS_SCORE};
+        static constexpr double MAX_SCORE{WIN_SCORE + static_cast<double>(game_parameters::MAX_SLOTS) * []() {
+            double max_item_score{0.0};
+            for(const double score : SCORES) max_item_score = std::max(max_item_score, score);
+            return max_item_score;
+        }()};
     };
 }
\ No newline at end of file
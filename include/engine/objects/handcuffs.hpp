@@ -1,10 +1,13 @@
 #pragma once
 
 #include <memory>
+#include <bitset>
+#include <cstdint>
+#include <stdexcept>
 
 namespace engine{
 
-    enum HandcuffType{
+    enum HandcuffType : uint8_t{
         None,
         Broken, // has ability to skip opponent move
         Intact // block adding handcuffs but have no ability
@@ -38,6 +41,10 @@ namespace engine{
             return type == None;
         }
 
+        HandcuffType getType() const{
+            return type;
+        }
+
         std::pair<std::bitset<32>, uint32_t> getHash() const{
             return {type == Broken? 0 : 1, 1};
         }
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <initializer_list>
+#include "engine/objects/types.hpp"
+#include "engine/game_parameters.hpp"
+
+namespace engine{
+
+    /// @brief Multiset of items packed as one 4-bit counter per item type into a single word.
+    /// The counter of an item is stored at bit 4 * (item - 1), Item::None has no counter.
+    class ItemSet{
+    public:
+        /// @brief Iterates over the distinct items of the set in the order of their type
+        class const_iterator{
+        public:
+            explicit const_iterator(const uint64_t occupied_mask) : mask(occupied_mask) {}
+
+            Item operator*() const { return static_cast<Item>(__builtin_ctzll(mask) / BITS_PER_ITEM + 1); }
+            const_iterator& operator++() { mask &= mask - 1; return *this; }
+            bool operator==(const const_iterator& other) const { return mask == other.mask; }
+            bool operator!=(const const_iterator& other) const { return mask != other.mask; }
+
+        private:
+            // lowest bit of every non-zero counter
+            uint64_t mask;
+        };
+
+        ItemSet() = default;
+        ItemSet(std::initializer_list<Item> items) { for(const auto item : items) add(item); }
+        ItemSet(const std::vector<Item>& items) { for(const auto item : items) add(item); }
+
+        void add(const Item item) {
+            assert(count(item) < COUNTER_MASK);
+            counts += getUnit(item);
+        }
+
+        void remove(const Item item) {
+            if(!contains(item)) {
+                throw std::runtime_error("Can't remove an item that is not owned");
+            }
+            counts -= getUnit(item);
+        }
+
+        void clear() { counts = 0; }
+
+        bool contains(const Item item) const { return counts & (COUNTER_MASK * getUnit(item)); }
+
+        unsigned int count(const Item item) const { return (counts >> getShift(item)) & COUNTER_MASK; }
+
+        /// @brief Total number of items (sum of all counters)
+        std::size_t size() const {
+            // add neighbouring counters into bytes and then all bytes into the top byte
+            const uint64_t pairs = (counts & BYTE_LOW_NIBBLES) + ((counts >> BITS_PER_ITEM) & BYTE_LOW_NIBBLES);
+            return (pairs * BYTE_LSBS) >> 56;
+        }
+
+        bool empty() const { return !counts; }
+
+        /// @brief Raw packed counters
+        uint64_t getCounts() const { return counts; }
+
+        std::vector<Item> toVector() const {
+            std::vector<Item> items;
+            for(const auto item : *this) items.insert(items.end(), count(item), item);
+            return items;
+        }
+
+        const_iterator begin() const {
+            const uint64_t occupied = counts | (counts >> 1) | (counts >> 2) | (counts >> 3);
+            return const_iterator(occupied & COUNTER_LSBS);
+        }
+        const_iterator end() const { return const_iterator(0); }
+
+        bool operator==(const ItemSet& other) const { return counts == other.counts; }
+        bool operator!=(const ItemSet& other) const { return counts != other.counts; }
+
+        static constexpr unsigned int BITS_PER_ITEM{4};
+        static constexpr uint64_t COUNTER_MASK{(1U << BITS_PER_ITEM) - 1};
+
+    private:
+        static constexpr unsigned int getShift(const Item item) {
+            assert(item != Item::None && item != Item::Count);
+            return BITS_PER_ITEM * (static_cast<unsigned int>(item) - 1);
+        }
+        static constexpr uint64_t getUnit(const Item item) { return uint64_t{1} << getShift(item); }
+
+        static constexpr uint64_t COUNTER_LSBS{0x0000'0001'1111'1111ULL};
+        static constexpr uint64_t BYTE_LOW_NIBBLES{0x0F0F'0F0F'0F0F'0F0FULL};
+        static constexpr uint64_t BYTE_LSBS{0x0101'0101'0101'0101ULL};
+        static_assert(BITS_PER_ITEM * game_parameters::ITEMS <= 64, "item counters must fit into one word");
+        static_assert(game_parameters::MAX_SLOTS <= COUNTER_MASK, "item counters must hold all slots");
+
+        uint64_t counts{0};
+    };
+}
\ No newline at end of file
@@ -1,11 +1,14 @@
 #pragma once
 
-#include <deque>
+#include <cstdint>
 #include <stdexcept>
 #include "engine/objects/types.hpp"
+#include "engine/game_parameters.hpp"
 
 namespace engine{
 
+    /// @brief Shells of the shotgun stored as bitboards.
+    /// Bit i of every mask belongs to the i-th round in the chamber (0 is the next round).
     class Magazine{
     public:
         void load(const unsigned int live_rounds, const unsigned int blank_rounds);
@@ -19,9 +22,9 @@ namespace engine{
         void ejectLiveRound();
         void convertBlankRound();
         void convertLiveRound();
-        
+
         unsigned int getRemainingRounds() const{
-            return round_knowledge.size();
+            return remaining_rounds;
         }
         unsigned int getRemainingBlankRounds() const{
             return total_blank_rounds;
@@ -29,15 +32,37 @@ namespace engine{
         unsigned int getRemainingLiveRounds() const{
             return total_live_rounds;
         }
+        unsigned int getUnknownBlankRounds() const{
+            return total_blank_rounds - __builtin_popcount(known_mask & ~live_mask);
+        }
+        unsigned int getUnknownLiveRounds() const{
+            return total_live_rounds - __builtin_popcount(known_mask & live_mask);
+        }
         bool couldDealerKnowRound(const unsigned int index = 0) const;
+        /// @brief Checks whether revealing a round to a participant adds no information
+        /// because they already know or can deduce its type
+        bool isRevealRedundant(const unsigned int index, const bool to_player) const;
         Round getDealerKnowledgeOfRound(const unsigned int index = 0) const;
         Round getPlayerKnowledgeOfRound(const unsigned int index = 0) const;
         double getProbabilityOfBlankRound(const unsigned int index = 0) const;
+        Round getTrueStateOfRound(const unsigned int index = 0) const;
+
+        bool operator==(const Magazine& other) const;
+
+        // rounds with a known true state
+        uint8_t known_mask{};
+        // rounds that are live, only valid where the true state is known
+        uint8_t live_mask{};
+        uint8_t player_knowledge_mask{};
+        uint8_t dealer_knowledge_mask{};
+        uint8_t possible_dealer_knowledge_mask{};
+        uint8_t remaining_rounds{};
+        uint8_t total_live_rounds{};
+        uint8_t total_blank_rounds{};
+
+    private:
+        Round getKnowledgeOfRound(const unsigned int index, const uint8_t knowledge_mask) const;
 
-        unsigned int unknown_live_rounds{};
-        unsigned int unknown_blank_rounds{};
-        unsigned int total_live_rounds{};
-        unsigned int total_blank_rounds{};
-        std::deque<RoundKnowledge> round_knowledge{};
+        static_assert(game_parameters::MAX_SHELLS <= 8, "rounds must fit into a byte mask");
     };
 }
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cassert>
+#include "engine/objects/types.hpp"
+
+namespace engine{
+
+    enum class Outcome : uint8_t{
+        None,
+        BlankRound,
+        LiveRound,
+        LoseLife,
+        GainLives
+    };
+
+    /// @brief Compact description of a transition from a state to one of its children.
+    /// Decisions store the chosen event, random events the drawn outcome.
+    struct Move{
+        double probability{1.0};
+        Event event{};
+        Outcome outcome{Outcome::None};
+        // round that is revealed by the glass or phone
+        uint8_t round_index{0};
+    };
+
+    /// @brief List of moves with a fixed capacity that is stored inline
+    class MoveList{
+    public:
+        // at most 9 distinct items and 2 shooting options, or 2 outcomes for 7 phone rounds
+        static constexpr std::size_t CAPACITY{16};
+
+        void push_back(const Move& move) {
+            assert(count < CAPACITY);
+            moves[count++] = move;
+        }
+
+        void clear() { count = 0; }
+
+        std::size_t size() const { return count; }
+        bool empty() const { return !count; }
+        const Move& operator[](const std::size_t index) const { assert(index < count); return moves[index]; }
+        Move& operator[](const std::size_t index) { assert(index < count); return moves[index]; }
+        const Move* begin() const { return moves.data(); }
+        const Move* end() const { return moves.data() + count; }
+
+    private:
+        std::array<Move, CAPACITY> moves;
+        uint8_t count{0};
+    };
+}
\ No newline at end of file
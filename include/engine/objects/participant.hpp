@@ -1,18 +1,19 @@
 #pragma once
 
-#include <vector>
 #include <tuple>
+#include <cstdint>
 #include <bitset>
 #include <stdexcept>
 #include <algorithm>
 #include "engine/objects/types.hpp"
+#include "engine/objects/item_set.hpp"
 #include "parameters.hpp"
 
 namespace engine{
 
     struct Participant{
-        unsigned int lives{0};
-        std::vector<Item> items{};
+        uint8_t lives{0};
+        ItemSet items{};
         
         void removeItem(Item item);
 
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <deque>
 #include <stdexcept>
 #include <algorithm>
 #include "engine/objects/magazine.hpp"
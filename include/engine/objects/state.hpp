@@ -1,9 +1,9 @@
 #pragma once
 
 #include <array>
-#include <vector>
-#include <deque>
 #include <tuple>
+#include <cstdint>
+#include <type_traits>
 #include <stdexcept>
 #include "engine/objects/participant.hpp"
 #include "engine/objects/shotgun.hpp"
@@ -20,9 +20,16 @@ namespace engine{
         Handcuffs handcuffs{};
         bool inverter_used{false};
         Event next_event{};
+
+        // last commutative item used since any other event,
+        // these items are only used in ascending order to skip permutations
+        Item last_item{Item::None};
         
         // handcuffs cannot be used twice in a row
-        unsigned int max_lives{};
+        uint8_t max_lives{};
+
+        // zobrist key, kept up to date by the state machine
+        uint64_t key{0};
 
         // apply some event
         void switchParticipantIfNotCuffed();
@@ -33,27 +40,28 @@ namespace engine{
         Participant& getOpponent();
         const Participant& getOpponent() const;
 
+        /// @brief Computes the zobrist key from scratch, a default constructed state has the key 0
+        uint64_t computeKey() const;
+
+        /// @brief Recomputes the key after the state has been modified by hand
+        void refreshKey();
+
+        /// @brief Derives the key from the parent by only toggling the features that differ
+        /// @param parent State this state was created from
+        void updateKey(const State& parent);
+
         bool operator==(const State& other) const;
     };
+
+    // states are copied for every child in the search tree
+    static_assert(std::is_trivially_copyable_v<State>, "State must be trivially copyable");
 }
 
 namespace std{
     template <>
     struct hash<engine::State> {
         std::size_t operator()(const engine::State& state) const {
-            const auto [h1, l1] = state.player.getHash(8); // 19
-            const auto [h2, l2] = state.dealer.getHash(8);
-            const auto [h3, l3] = state.shotgun.getHash(8); // 9
-            const auto [h4, l4] = state.handcuffs.getHash(); // 1
-            const auto [h5, l5] = state.next_event.getHash(); // 2
-
-            std::size_t hash = h1.to_ulong() ^ h2.to_ulong();
-            hash = hash << l3 | h3.to_ulong();
-            hash = hash << l4 | h4.to_ulong();
-            hash = hash << l5 | h5.to_ulong();
-            hash = hash << 1 | (state.max_lives % 2);
-            hash = hash << 1 | state.inverter_used;
-            return hash;
+            return state.key;
         }
     };
 }
\ No newline at end of file
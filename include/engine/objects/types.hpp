@@ -4,7 +4,7 @@
 #include <cstdint>
 
 namespace engine{
-    enum class Item : unsigned int{
+    enum class Item : uint8_t{
         None,
         Cigarette,
         Glass,
@@ -18,35 +18,13 @@ namespace engine{
         Count
     };
     
-    enum class Round : unsigned int{
+    enum class Round : uint8_t{
         Unknown,
         BlankRound,
         LiveRound
     };
 
-    struct RoundKnowledge {
-        Round true_state{Round::Unknown};
-        bool player_knowledge{false};
-        bool dealer_knowledge{false};
-        bool possible_dealer_knowledge{false};
-
-        bool getHash() const{
-            return player_knowledge ^ dealer_knowledge ^ (true_state != Round::LiveRound);
-        }
-
-        bool operator==(const RoundKnowledge& other) const {
-            if (player_knowledge != other.player_knowledge || dealer_knowledge != other.dealer_knowledge || true_state != other.true_state) {
-                return false;
-            }
-            return true;
-        }
-
-        bool operator!=(const RoundKnowledge& other) const {
-            return !(*this == other);
-        }
-    };
-    
-    enum class Action : unsigned int{
+    enum class Action : uint8_t{
         Evaluating,
         ShootSelf,
         ShootOther,
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "engine/objects/types.hpp"
+#include "engine/objects/handcuffs.hpp"
+#include "engine/game_parameters.hpp"
+
+namespace engine{
+    namespace zobrist{
+
+        constexpr std::size_t SIDES{2};
+        // lives are stored in a byte but never exceed twice the maximum
+        constexpr std::size_t LIVES_RANGE{2 * game_parameters::MAX_LIVES};
+        constexpr std::size_t COUNTER_RANGE{16};
+        // one key per value of each magazine bitboard
+        constexpr std::size_t MASK_RANGE{1U << game_parameters::MAX_SHELLS};
+        constexpr std::size_t SHELL_RANGE{game_parameters::MAX_SHELLS + 1};
+        constexpr std::size_t ACTIONS{4};
+
+        /// @brief Random keys of all features of a state
+        struct Keys{
+            uint64_t lives[SIDES][LIVES_RANGE]{};
+            uint64_t items[SIDES][game_parameters::ITEMS][COUNTER_RANGE]{};
+            uint64_t known_rounds[MASK_RANGE]{};
+            uint64_t live_rounds[MASK_RANGE]{};
+            uint64_t player_knowledge[MASK_RANGE]{};
+            uint64_t dealer_knowledge[MASK_RANGE]{};
+            // indexed by the number of live and blank rounds
+            uint64_t shells[SHELL_RANGE][SHELL_RANGE]{};
+            uint64_t max_lives[LIVES_RANGE]{};
+            uint64_t handcuffs[3]{};
+            uint64_t actions[ACTIONS]{};
+            uint64_t event_items[static_cast<std::size_t>(Item::Count)]{};
+            uint64_t last_items[static_cast<std::size_t>(Item::Count)]{};
+            uint64_t saw{};
+            uint64_t inverter{};
+            uint64_t player_turn{};
+        };
+
+        /// @brief Fills the key tables with a splitmix64 sequence at compile time
+        constexpr Keys generateKeys() {
+            Keys keys{};
+            uint64_t seed{0x2545F4914F6CDD1DULL};
+            auto next = [&seed]() {
+                uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                return z ^ (z >> 31);
+            };
+            for(auto& side : keys.lives) for(auto& key : side) key = next();
+            for(auto& side : keys.items) for(auto& item : side) for(auto& key : item) key = next();
+            for(auto& key : keys.known_rounds) key = next();
+            for(auto& key : keys.live_rounds) key = next();
+            for(auto& key : keys.player_knowledge) key = next();
+            for(auto& key : keys.dealer_knowledge) key = next();
+            for(auto& live : keys.shells) for(auto& key : live) key = next();
+            for(auto& key : keys.max_lives) key = next();
+            for(auto& key : keys.handcuffs) key = next();
+            for(auto& key : keys.actions) key = next();
+            for(auto& key : keys.event_items) key = next();
+            keys.saw = next();
+            keys.inverter = next();
+            keys.player_turn = next();
+            // no key for Item::None so default states keep the key 0
+            for(std::size_t item = 1; item < static_cast<std::size_t>(Item::Count); ++item) keys.last_items[item] = next();
+            return keys;
+        }
+
+        inline constexpr Keys KEYS{generateKeys()};
+    }
+}
\ No newline at end of file
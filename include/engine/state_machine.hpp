@@ -1,14 +1,36 @@
 #pragma once
 
 #include "engine/objects/state.hpp"
+#include "engine/objects/move.hpp"
+#include "arena.hpp"
 #include <memory>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cassert>
 
 namespace engine{
 
+    /// @brief Orders the first count indices by descending score, indices with equal scores keep their order.
+    /// Insertion sort never asks for a temporary buffer like std::stable_sort does.
+    template <std::size_t CAPACITY>
+    void sortByScore(std::array<std::uint8_t, CAPACITY>& order, const std::array<std::uint32_t, CAPACITY>& scores, const std::size_t count) {
+        for(std::size_t position = 1; position < count; ++position) {
+            const std::uint8_t index = order[position];
+            std::size_t target = position;
+            for(; target && scores[order[target - 1]] < scores[index]; --target) order[target] = order[target - 1];
+            order[target] = index;
+        }
+    }
+
     class StateMachine {
     public:
         using State = engine::State;
         using Event = engine::Event;
+        using Move = engine::Move;
+        using MoveList = engine::MoveList;
+        // states are small enough to be restored from a copy
+        using Undo = engine::State;
 
         /// @brief Checks whether a node is a terminal node
         /// @param state State to evaluate
@@ -32,11 +54,99 @@ namespace engine{
         /// @return Max depth until a finished state must be reached
         static unsigned int getMaxDepth(const State& state);
 
+        /// @brief Checks whether adrenalin would allow to use any of the opponent's items
+        /// @param state State to evaluate
+        /// @return True if at least one opponent item may be stolen
+        static bool hasUsableOpponentItem(const State& state);
+
+        /// @brief Counts the children of a state without creating them
+        /// @param state State to evaluate
+        /// @return Number of children getChildStates would create
+        static std::size_t countChildren(const State& state);
+
+        /// @brief Checks whether a state has only a single successor
+        /// @param state State to evaluate
+        /// @return True if the next move is forced
+        static bool isForcedMove(const State& state);
+
         /// @brief Creates child states for a given state
         /// @param parent Parent state
         /// @return List of child states with probabilities
         static std::vector<std::unique_ptr<State>> getChildStates(const State& parent);
 
+        /// @brief Creates child states for a given state inside an arena
+        /// @param parent Parent state
+        /// @param memory Arena that owns the children until it is released
+        /// @return List of child states with probabilities
+        static arena::Span<State> getChildStates(const State& parent, arena::Arena& memory);
+
+        /// @brief Creates the children of a state one at a time, in the same order as getChildStates
+        class ChildGenerator {
+        public:
+            explicit ChildGenerator(const State& parent);
+
+            /// @brief Number of children the parent has in total
+            std::size_t size() const { return moves.size(); }
+
+            /// @brief Number of children that have not been created yet
+            std::size_t remaining() const { return moves.size() - index; }
+
+            bool hasNext() const { return index < moves.size(); }
+
+            /// @brief Creates the next child
+            /// @return Child state with its probability
+            State next();
+
+            /// @brief Creates the child of the given move first, must be called before the first child is created
+            /// @param move_index Index of the move in the order of getChildStates
+            void prioritize(const std::size_t move_index);
+
+            /// @brief Orders the children by descending score of their moves, must be called before the first child is created.
+            /// Moves with equal scores keep their order.
+            /// @param getScore Rates a move
+            template <typename Scorer>
+            void sort(const Scorer& getScore) {
+                assert(!index);
+                std::array<std::uint32_t, MoveList::CAPACITY> scores;
+                for(std::size_t move_index = 0; move_index < moves.size(); ++move_index) scores[move_index] = getScore(moves[move_index]);
+                sortByScore(order, scores, moves.size());
+            }
+
+            /// @brief Index of the last created child in the order of getChildStates
+            std::size_t getMoveIndex() const { return order[index - 1]; }
+
+            /// @brief Move that created the last child
+            const Move& getMove() const { return moves[getMoveIndex()]; }
+
+            /// @brief Moves of all children in the order of getChildStates
+            const MoveList& getMoves() const { return moves; }
+
+        private:
+            const State& parent;
+            MoveList moves;
+            // order in which the moves are applied
+            std::array<std::uint8_t, MoveList::CAPACITY> order;
+            std::size_t index{0};
+        };
+
+        /// @brief Lists all transitions of a state without creating the children
+        /// @param state State to expand
+        /// @param moves Filled with the moves in the same order as getChildStates
+        static void generateMoves(const State& state, MoveList& moves);
+
+        /// @brief Turns a state into one of its children in place
+        /// @param state State to modify
+        /// @param move Move created by generateMoves for this state
+        /// @return Record to restore the state with undo
+        static Undo apply(State& state, const Move& move);
+
+        /// @brief Reverts a previously applied move
+        /// @param state State to restore
+        /// @param record Record returned by apply
+        static inline void undo(State& state, const Undo& record) {
+            state = record;
+        }
+
         /// @brief Computes the probability of a blank round appearing
         /// @param state State to evaluate
         /// @param inverter_used whether inverter has been used
@@ -45,22 +155,22 @@ namespace engine{
         static double getProbabilityOfBlankRound(const State& state, const bool inverter_used, const unsigned int index = 0);
 
     private:
-        static std::vector<std::unique_ptr<State>> getEvaluatingChildStates(const State& parent, const bool use_opponent_items = false);
-        static std::vector<std::unique_ptr<State>> getPlayerEvaluatingChildStates(const State& parent, const bool use_opponent_items = false);
-        static std::vector<std::unique_ptr<State>> getDealerEvaluatingChildStates(const State& parent, const bool use_opponent_items = false);
-        static std::vector<std::unique_ptr<State>> getShootSelfChildStates(const State& parent);
-        static std::vector<std::unique_ptr<State>> getShootOtherChildStates(const State& parent);
-        static std::vector<std::unique_ptr<State>> getUseItemChildStates(const State& parent);
-        static std::vector<std::unique_ptr<State>> getGainedRoundKnowledgeChildStates(const State& parent, const unsigned int index);
-        static std::unique_ptr<State> getCigaretteChildState(const State& parent);
-        static std::vector<std::unique_ptr<State>> getGlassChildStates(const State& parent);
-        static std::unique_ptr<State> getSawChildState(const State& parent);
-        static std::unique_ptr<State> getHandcuffsChildState(const State& parent);
-        static std::vector<std::unique_ptr<State>> getPhoneChildStates(const State& parent);
-        static std::vector<std::unique_ptr<State>> getBeerChildStates(const State& parent);
-        static std::vector<std::unique_ptr<State>> getPillsChildStates(const State& parent);
-        static std::unique_ptr<State> getInverterChildState(const State& parent);
-        static std::vector<std::unique_ptr<State>> getInverterChildStates(const State& parent);
-        static std::vector<std::unique_ptr<State>> getAdrenalinChildStates(const State& parent);
+        static void addEvaluatingMoves(const State& state, MoveList& moves, const bool use_opponent_items = false);
+        static void addPlayerEvaluatingMoves(const State& state, MoveList& moves, const bool use_opponent_items);
+        static void addDealerEvaluatingMoves(const State& state, MoveList& moves, const bool use_opponent_items);
+        static void addRoundMoves(const State& state, MoveList& moves, const unsigned int index = 0, const double probability = 1.0);
+        static void addUseItemMoves(const State& state, MoveList& moves);
+        static void addPhoneMoves(const State& state, MoveList& moves);
+        static void applyDecision(State& state, const Move& move, const bool use_opponent_items = false);
+        static void applyShootSelf(State& state, const Move& move);
+        static void applyShootOther(State& state, const Move& move);
+        static void applyUseItem(State& state, const Move& move);
+        static void applyGainedRoundKnowledge(State& state, const Move& move);
+        static void applyBeer(State& state, const Move& move);
+        static void applyPills(State& state, const Move& move);
+        static void useCigarette(State& state);
+        static void useSaw(State& state);
+        static void useHandcuffs(State& state);
+        static void useInverter(State& state);
     };
 }
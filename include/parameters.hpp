@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace parameters{
 
     // probabilities smaller than this are considered as impossible 
@@ -8,9 +10,34 @@ namespace parameters{
     // use this as the maximum shallow depth
     static constexpr unsigned int MAX_SHALLOW_DEPTH{3};
     
+    // nodes with less remaining depth are not split between threads
+    static constexpr unsigned int MIN_SPLIT_DEPTH{6};
+
+    // random events with less remaining depth search their outcomes one after another
+    static constexpr unsigned int MIN_OUTCOME_SPLIT_DEPTH{8};
+
+    // memory of each transposition table in megabytes
+    static constexpr std::size_t TRANSPOSITION_TABLE_SIZE_MB{32};
+
+    // half width of the aspiration windows of iterative deepening, as a share of the score range of the evaluator
+    static constexpr double ASPIRATION_WINDOW{0.01};
+
+    // iterative deepening that stops early ends once this many iterations in a row agree on the best move and score,
+    // three let the agent stop on a plateau of the score before deeper iterations find a better line
+    static constexpr unsigned int STABLE_ITERATIONS{4};
+
+    // scores of iterations that differ by less than this share of the score range of the evaluator count as equal
+    static constexpr double STABLE_SCORE_MARGIN{0.001};
+
+    // searches look at their cancellation token every this many nodes
+    static constexpr std::size_t CANCELLATION_CHECK_INTERVAL{1024};
+
     // default time limit
     static constexpr double TIME_LIMIT{30.0};
 
+    // share of the time limit after which iterative deepening starts no further iteration
+    static constexpr double SOFT_TIME_LIMIT_SHARE{0.5};
+
     // by default, the dealer will use the ingame logic
     static constexpr bool DEALER_USES_PLAYER_LOGIC{false};
 }
\ No newline at end of file
@@ -85,6 +85,7 @@ namespace randomizer{
                     state.shotgun.makeDealerPossiblyKnowRound(index);
                 }
             }
+            state.refreshKey();
             return state;
         }
     };
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace search{
+
+    // score of a search that was aborted, callers pass it up the stack without using or storing it
+    inline constexpr double ABORTED_SCORE{std::numeric_limits<double>::quiet_NaN()};
+
+    /// @brief Checks whether a score stems from an aborted search
+    inline bool isAborted(const double score) { return std::isnan(score); }
+
+    /// @brief Stops a single search, every thread that works on the search shares its token.
+    /// Besides explicit cancellation the token carries the limits of the running search, which its TimeManager sets.
+    class CancellationToken {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+
+        /// @brief Allows the search to run again
+        void reset() {
+            cancelled.store(false, std::memory_order_relaxed);
+            expired.store(false, std::memory_order_relaxed);
+        }
+
+        /// @return Whether the search was cancelled or ran out of time or nodes
+        bool isCancelled() const { return cancelled.load(std::memory_order_relaxed) || expired.load(std::memory_order_relaxed); }
+
+        /// @brief Counts the nodes that a search thread visited since its last poll, reaching the node limit stops the search
+        /// @return Whether the search is cancelled
+        bool poll(const std::size_t nodes) {
+            const std::size_t total = visited_nodes.fetch_add(nodes, std::memory_order_relaxed) + nodes;
+            if(node_limit && total >= node_limit) expired.store(true, std::memory_order_relaxed);
+            return isCancelled();
+        }
+
+        /// @brief Checks whether an iteration that is expected to take the given time and nodes should be started
+        /// @return False after the soft deadline or if the iteration would not be finished within the limits
+        bool canStartIteration(const double seconds, const std::size_t nodes) const {
+            const auto now = Clock::now();
+            if(now >= soft_deadline) return false;
+            if(std::chrono::duration<double>(hard_deadline - now).count() < seconds) return false;
+            return !node_limit || visited_nodes.load(std::memory_order_relaxed) + nodes <= node_limit;
+        }
+
+    private:
+        friend class TimeManager;
+
+        std::atomic<bool> cancelled{false};
+        // set once a limit of the search was reached, the time manager clears it after the search
+        std::atomic<bool> expired{false};
+        std::atomic<std::size_t> visited_nodes{0};
+        // limits of the running search, they are only changed while no search runs
+        std::size_t node_limit{0};
+        Clock::time_point soft_deadline{Clock::time_point::max()};
+        Clock::time_point hard_deadline{Clock::time_point::max()};
+    };
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <cassert>
+#include <cstddef>
+#include <optional>
+#include <algorithm>
+
+namespace search{
+
+    // pruning of chance nodes with the score bounds of the evaluator, see Ballard's *-minimax
+    enum class ChancePruning {
+        None,  // every outcome is searched with an open window
+        Star1, // outcomes are searched with windows derived from the parent window and the bounds of the other outcomes
+        Star2  // outcomes that are decision nodes are probed with a single move first to tighten their bounds
+    };
+
+    /// @brief Window of the expected score at a chance node.
+    /// Every outcome starts with the score bounds of the evaluator, which tighten while outcomes are probed or searched.
+    /// Once the weighted bounds of all outcomes leave the window of the parent, the remaining outcomes cannot change the decision above.
+    /// Outcomes are identified by their index in the order of getChildStates.
+    template <std::size_t CAPACITY>
+    class ChanceWindow {
+    public:
+        ChanceWindow(const double alpha, const double beta, const double min_score, const double max_score)
+            : alpha(alpha), beta(beta), min_score(min_score), max_score(max_score) {}
+
+        /// @brief Adds an outcome that has not been looked at yet
+        void addOutcome(const double probability) {
+            assert(count < CAPACITY);
+            outcomes[count++] = {probability, min_score, max_score};
+            lower_sum += probability * min_score;
+            upper_sum += probability * max_score;
+        }
+
+        std::size_t size() const { return count; }
+
+        /// @brief Lowest score of the outcome that can still keep the expected score at or above alpha
+        double getAlpha(const std::size_t index) const {
+            const Outcome& outcome = outcomes[index];
+            return (alpha - (upper_sum - outcome.probability * outcome.upper)) / outcome.probability;
+        }
+
+        /// @brief Highest score of the outcome that can still keep the expected score at or below beta
+        double getBeta(const std::size_t index) const {
+            const Outcome& outcome = outcomes[index];
+            return (beta - (lower_sum - outcome.probability * outcome.lower)) / outcome.probability;
+        }
+
+        /// @brief Checks whether a probe that needs to beat the score can cut the chance node at all
+        bool isReachable(const double score) const { return score >= min_score && score <= max_score; }
+
+        void setLower(const std::size_t index, const double score) {
+            Outcome& outcome = outcomes[index];
+            if(score <= outcome.lower) return;
+            lower_sum += outcome.probability * (score - outcome.lower);
+            outcome.lower = score;
+        }
+
+        void setUpper(const std::size_t index, const double score) {
+            Outcome& outcome = outcomes[index];
+            if(score >= outcome.upper) return;
+            upper_sum += outcome.probability * (score - outcome.upper);
+            outcome.upper = score;
+        }
+
+        /// @return Bound of the expected score if it already lies outside of the window
+        std::optional<double> getCut() const {
+            if(lower_sum > beta) return lower_sum;
+            if(upper_sum < alpha) return upper_sum;
+            return std::nullopt;
+        }
+
+        /// @brief Stores the result of an outcome that was searched with the window of getAlpha and getBeta
+        /// @return Bound of the expected score if the result failed high or low
+        std::optional<double> setScore(const std::size_t index, const double score) {
+            const double outcome_alpha = getAlpha(index);
+            const double outcome_beta = getBeta(index);
+            if(score > outcome_beta) {
+                setLower(index, score);
+                // rounding must not turn the bound into a score inside of the window
+                return std::max(lower_sum, std::nextafter(beta, std::numeric_limits<double>::infinity()));
+            }
+            if(score < outcome_alpha) {
+                setUpper(index, score);
+                return std::min(upper_sum, std::nextafter(alpha, -std::numeric_limits<double>::infinity()));
+            }
+            setLower(index, score);
+            setUpper(index, score);
+            return std::nullopt;
+        }
+
+    private:
+        struct Outcome{
+            double probability{0.0};
+            double lower{0.0};
+            double upper{0.0};
+        };
+
+        double alpha;
+        double beta;
+        double min_score;
+        double max_score;
+        // expected score if every outcome scored its lower or upper bound
+        double lower_sum{0.0};
+        double upper_sum{0.0};
+        std::array<Outcome, CAPACITY> outcomes;
+        std::size_t count{0};
+    };
+}
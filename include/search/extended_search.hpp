@@ -1,11 +1,18 @@
 #pragma once
 
-#include <deque>
 #include <memory>
+#include <array>
+#include <numeric>
+#include <algorithm>
 #include <cassert>
-#include <stdexcept>
 #include <limits>
 #include "parameters.hpp"
+#include "arena.hpp"
+#include "search/inline_deque.hpp"
+#include "search/search_traits.hpp"
+#include "search/chance_pruning.hpp"
+#include "search/move_ordering.hpp"
+#include "search/cancellation_token.hpp"
 
 namespace search{
 
@@ -17,8 +24,13 @@ namespace search{
         using State = typename StateMachine::State;
         using Event = typename StateMachine::Event;
 
+        using ChanceWindow = search::ChanceWindow<StateMachine::MoveList::CAPACITY>;
+        static constexpr ChancePruning CHANCE_PRUNING{chance_pruning_of<BaseSearch>::value};
+
+        using BaseSearch::BaseSearch;
+
         struct Result{
-            std::deque<Event> follow_ups{}; // all choices until next random event
+            InlineDeque<Event, 64> follow_ups{}; // all choices until next random event
             double score {0.0};
 
             bool operator==(const Result& other) const {
@@ -44,24 +56,38 @@ namespace search{
         /// @return A combination of the best choice of action, the score of that result and the total number of evaluated states
         
         Result expectiminimax(const State& parent, const uint32_t depth, const uint32_t deep_depth = 0, double alpha = -std::numeric_limits<double>::infinity(), double beta = std::numeric_limits<double>::infinity());
+
+    private:
+        // searches only the first decision of an outcome of a random event (Star2)
+        void probe(const State& outcome, const uint32_t depth, const uint32_t deep_depth, ChanceWindow& window, const std::size_t index);
     };
 
     template <typename BaseSearch>
     typename ExtendedSearch<BaseSearch>::Result ExtendedSearch<BaseSearch>::expectiminimax(const State& parent, const uint32_t depth, const uint32_t deep_depth, double alpha, double beta){
         // terminal nodes
         if(StateMachine::isFinished(parent) || !depth) {
-            if(deep_depth) return Result{{}, BaseSearch::expectiminimax(parent, deep_depth, alpha, beta)};
+            if(deep_depth) {
+                if constexpr (has_leaf_search<BaseSearch>::value) return Result{{}, BaseSearch::searchLeaf(parent, deep_depth, alpha, beta)};
+                else return Result{{}, BaseSearch::expectiminimax(parent, deep_depth, alpha, beta)};
+            }
+            ++this->node_count;
+            if constexpr (has_exact_score<Evaluator>::value) {
+                if(const auto score = Evaluator::getExactScore(parent)) return Result{{}, *score};
+            }
             return Result{{}, Evaluator::getScore(parent)};
         }
+        ++this->node_count;
         // get children:
         Result end_result;
         const bool is_evaluation = StateMachine::isEvaluationPhase(parent.next_event);
-        auto children = StateMachine::getChildStates(parent);
+        // children are released when this node returns, results are stored inline and outlive them
+        arena::Arena::Scope scope{arena::Arena::local()};
+        const auto children = StateMachine::getChildStates(parent, scope.getArena());
         assert(!children.empty());
         if(children.size() == 1) {
             // skip single childs in depth computation
-            end_result = expectiminimax(*children.front(), depth, deep_depth, alpha, beta);
-            const auto& next_event = children.front()->next_event;
+            end_result = expectiminimax(children.front(), depth, deep_depth, alpha, beta);
+            const auto& next_event = children.front().next_event;
             if(next_event.action != engine::Action::Evaluating)
                 end_result.follow_ups.push_front(next_event);
             return end_result;
@@ -71,26 +97,53 @@ namespace search{
             // current participant will optimize their move
             Event best_event;
 
+            std::size_t best_index{children.size()};
+
             const bool is_player_turn = StateMachine::isPlayerTurn(parent);
             end_result.score = is_player_turn ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
 
-            for( auto& child : children ) {
-                const auto result = expectiminimax(*child, depth-1, deep_depth, alpha, beta);
+            std::array<std::uint8_t, StateMachine::MoveList::CAPACITY> order;
+            std::iota(order.begin(), order.begin() + children.size(), 0);
+            if constexpr (has_move_ordering<BaseSearch>::value) {
+                if constexpr (BaseSearch::MoveOrdering::ENABLED) {
+                    std::array<std::uint32_t, StateMachine::MoveList::CAPACITY> scores;
+                    for(std::size_t index = 0; index < children.size(); ++index) {
+                        scores[index] = this->move_ordering.getScore(parent, children[index].next_event, depth);
+                    }
+                    sortByScore(order, scores, children.size());
+                }
+            }
+
+            for(std::size_t position = 0; position < children.size(); ++position) {
+                const std::size_t index = order[position];
+                const auto& child = children[index];
+                const auto result = expectiminimax(child, depth-1, deep_depth, alpha, beta);
+                if(isAborted(result.score)) return result;
+                // equal scores prefer the child that comes first in generation order, whatever order they were searched in
+                const bool is_tie = result.score == end_result.score && index < best_index;
                 if(is_player_turn) {
-                    if (result.score > end_result.score) {
+                    if (result.score > end_result.score || is_tie) {
                         end_result = std::move(result);
-                        best_event = std::move(child->next_event);
+                        best_event = child.next_event;
+                        best_index = index;
                     }
                     // alpha-beta pruning
-                    if (end_result.score > beta) break;
+                    if (end_result.score > beta) {
+                        if constexpr (has_move_ordering<BaseSearch>::value) this->move_ordering.addCutoff(parent, child.next_event, depth);
+                        break;
+                    }
                     alpha = std::max(alpha, end_result.score);
                 } else {
-                    if (result.score < end_result.score) {
+                    if (result.score < end_result.score || is_tie) {
                         end_result = std::move(result);
-                        best_event = std::move(child->next_event);
+                        best_event = child.next_event;
+                        best_index = index;
                     }
                     // alpha-beta pruning
-                    if (end_result.score < alpha) break;
+                    if (end_result.score < alpha) {
+                        if constexpr (has_move_ordering<BaseSearch>::value) this->move_ordering.addCutoff(parent, child.next_event, depth);
+                        break;
+                    }
                     beta = std::min(beta, end_result.score);
                 }
             }
@@ -99,16 +152,79 @@ namespace search{
         } else {
             // random event happens
             double total_probability = 0.0;
-            for( const auto& child : children ) {
-                // accumulate results
-                const Result result = expectiminimax(*child, depth-1, deep_depth, alpha, beta);
-                total_probability += child->probability;
-                // end_result.follow_ups = result.follow_ups;
-                // end_result.follow_ups.push_front(child->next_event);
-                end_result.score += child->probability * result.score;
+            if constexpr (CHANCE_PRUNING == ChancePruning::None) {
+                for( const auto& child : children ) {
+                    // accumulate results
+                    // the window bounds the weighted sum, not single outcomes, so outcomes are searched without one
+                    const Result result = expectiminimax(child, depth-1, deep_depth, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity());
+                    if(isAborted(result.score)) return result;
+                    total_probability += child.probability;
+                    // end_result.follow_ups = result.follow_ups;
+                    // end_result.follow_ups.push_front(child.next_event);
+                    end_result.score += child.probability * result.score;
+                }
+            } else {
+                ChanceWindow window{alpha, beta, Evaluator::MIN_SCORE, Evaluator::MAX_SCORE};
+                for( const auto& child : children ) window.addOutcome(child.probability);
+                if constexpr (CHANCE_PRUNING == ChancePruning::Star2) {
+                    for(std::size_t index = 0; index < children.size(); ++index) {
+                        probe(children[index], depth-1, deep_depth, window, index);
+                        if(const auto cut = window.getCut()) {
+                            end_result.score = *cut;
+                            return end_result;
+                        }
+                    }
+                }
+                for(std::size_t index = 0; index < children.size(); ++index) {
+                    // accumulate results
+                    const auto& child = children[index];
+                    // the window of an outcome is as wide as the other outcomes allow (Star1)
+                    const Result result = expectiminimax(child, depth-1, deep_depth, window.getAlpha(index), window.getBeta(index));
+                    if(isAborted(result.score)) return result;
+                    if(const auto cut = window.setScore(index, result.score)) {
+                        end_result.score = *cut;
+                        return end_result;
+                    }
+                    total_probability += child.probability;
+                    end_result.score += child.probability * result.score;
+                }
             }
             assert(std::abs(total_probability - 1.0) < parameters::EPSILON);
             return end_result;
         }
     }
+
+    template <typename BaseSearch>
+    void ExtendedSearch<BaseSearch>::probe(const State& outcome, const uint32_t depth, const uint32_t deep_depth, ChanceWindow& window, const std::size_t index){
+        // only decisions that are searched deeper can be probed
+        if(StateMachine::isFinished(outcome) || !depth || !StateMachine::isEvaluationPhase(outcome.next_event)) return;
+        arena::Arena::Scope scope{arena::Arena::local()};
+        const auto children = StateMachine::getChildStates(outcome, scope.getArena());
+        if(children.size() == 1) return;
+        // probe the decision the full search would try first
+        std::size_t first{0};
+        if constexpr (has_move_ordering<BaseSearch>::value) {
+            if constexpr (BaseSearch::MoveOrdering::ENABLED) {
+                std::uint32_t best_score{this->move_ordering.getScore(outcome, children[0].next_event, depth)};
+                for(std::size_t child_index = 1; child_index < children.size(); ++child_index) {
+                    const std::uint32_t score = this->move_ordering.getScore(outcome, children[child_index].next_event, depth);
+                    if(score > best_score) {
+                        best_score = score;
+                        first = child_index;
+                    }
+                }
+            }
+        }
+        if(StateMachine::isPlayerTurn(outcome)) {
+            const double target = window.getBeta(index);
+            if(!window.isReachable(target)) return;
+            const double result = expectiminimax(children[first], depth-1, deep_depth, target, target).score;
+            if(result >= target) window.setLower(index, result);
+        } else {
+            const double target = window.getAlpha(index);
+            if(!window.isReachable(target)) return;
+            const double result = expectiminimax(children[first], depth-1, deep_depth, target, target).score;
+            if(result <= target) window.setUpper(index, result);
+        }
+    }
 }
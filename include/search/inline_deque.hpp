@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cassert>
+#include <iterator>
+
+namespace search{
+
+    /// @brief Double ended queue with a fixed capacity that stores its elements inline.
+    /// Copying and moving never touches the global allocator, so it can be returned by value from every node.
+    template <typename T, std::size_t CAPACITY>
+    class InlineDeque {
+        static_assert(CAPACITY && !(CAPACITY & (CAPACITY - 1)), "capacity must be a power of two");
+        static constexpr std::size_t MASK{CAPACITY - 1};
+
+    public:
+        template <typename Deque, typename Value>
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Value*;
+            using reference = Value&;
+
+            Iterator(Deque* deque, const std::size_t index) : deque(deque), index(index) {}
+
+            reference operator*() const { return (*deque)[index]; }
+            pointer operator->() const { return &(*deque)[index]; }
+            Iterator& operator++() { ++index; return *this; }
+            Iterator operator++(int) { auto copy = *this; ++index; return copy; }
+            bool operator==(const Iterator& other) const { return index == other.index; }
+            bool operator!=(const Iterator& other) const { return index != other.index; }
+
+        private:
+            Deque* deque;
+            std::size_t index;
+        };
+
+        using iterator = Iterator<InlineDeque, T>;
+        using const_iterator = Iterator<const InlineDeque, const T>;
+
+        std::size_t size() const { return count; }
+        bool empty() const { return !count; }
+        static constexpr std::size_t capacity() { return CAPACITY; }
+
+        void clear() {
+            head = 0;
+            count = 0;
+        }
+
+        void push_front(const T& value) {
+            assert(count < CAPACITY);
+            head = (head + MASK) & MASK;
+            data[head] = value;
+            ++count;
+        }
+
+        void push_back(const T& value) {
+            assert(count < CAPACITY);
+            data[(head + count) & MASK] = value;
+            ++count;
+        }
+
+        void pop_front() {
+            assert(count);
+            head = (head + 1) & MASK;
+            --count;
+        }
+
+        void pop_back() {
+            assert(count);
+            --count;
+        }
+
+        T& front() { assert(count); return data[head]; }
+        const T& front() const { assert(count); return data[head]; }
+
+        T& back() { assert(count); return data[(head + count - 1) & MASK]; }
+        const T& back() const { assert(count); return data[(head + count - 1) & MASK]; }
+
+        T& operator[](const std::size_t index) { assert(index < count); return data[(head + index) & MASK]; }
+        const T& operator[](const std::size_t index) const { assert(index < count); return data[(head + index) & MASK]; }
+
+        iterator begin() { return {this, 0}; }
+        iterator end() { return {this, count}; }
+        const_iterator begin() const { return {this, 0}; }
+        const_iterator end() const { return {this, count}; }
+
+    private:
+        std::array<T, CAPACITY> data{};
+        std::size_t head{0};
+        std::size_t count{0};
+    };
+}
@@ -6,10 +6,22 @@
 #include <thread>
 #include <future>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
 #include "parameters.hpp"
+#include "search/search_traits.hpp"
+#include "search/cancellation_token.hpp"
+#include "search/time_manager.hpp"
+#include "search/transposition_table.hpp"
 
 namespace search{
-    template <typename BaseSearch>
+    /// @brief Searches with increasing depth until the depth is reached, the limits of the cancellation token run out or the result is known.
+    /// Iterations stop once the whole tree was searched or the score is a proven win or loss.
+    /// With STOP_WHEN_STABLE searches at the root also stop once the last iterations agree on the best move and exact score.
+    /// Around a search with a shallow part like ThreadedSearch the iterations grow the shallow part first and then the deep part.
+    template <typename BaseSearch, bool ASPIRATION_WINDOWS = false, bool STOP_WHEN_STABLE = false>
     class IterativeSearch : public BaseSearch {
     public:
         using Evaluator = typename BaseSearch::Evaluator;
@@ -18,27 +30,160 @@ namespace search{
         using Event = typename StateMachine::Event;
         using Result = typename BaseSearch::Result;
 
+        using BaseSearch::BaseSearch;
+
+        static_assert(!ASPIRATION_WINDOWS || !has_root_search<BaseSearch>::value, "searches with a shallow part take no windows");
+
         /// @brief Performs the minimax algorithm with threading
         /// @param parent state to evaluate
         /// @param depth max shallow depth to evaluate
         /// @param alpha lower bound for alpha-beta pruning
         /// @param beta upper bound for alpha-beta pruning
         /// @return best score that the parent gets
-        Result expectiminimax(const State& parent, const uint32_t depth, double alpha = -std::numeric_limits<double>::infinity(), double beta = std::numeric_limits<double>::infinity());
+        template <typename Base = BaseSearch, std::enable_if_t<!has_root_search<Base>::value, int> = 0>
+        Result expectiminimax(const State& parent, const uint32_t depth, double alpha = -std::numeric_limits<double>::infinity(), double beta = std::numeric_limits<double>::infinity()) {
+            return iterate(parent, depth, 0, alpha, beta, true);
+        }
+
+        /// @brief Performs the minimax algorithm on a search with a shallow part, the iterations share the limits
+        /// @param parent state to evaluate
+        /// @param depth max shallow depth to evaluate
+        /// @param deep_depth max deep depth to evaluate
+        /// @param limits abort evaluation after the time or node limit was reached, no iteration starts after the soft time limit
+        /// @return choices and score of the deepest completed iteration
+        template <typename Base = BaseSearch, std::enable_if_t<has_root_search<Base>::value, int> = 0>
+        Result expectiminimax(const State& parent, const uint32_t depth, const uint32_t deep_depth, const SearchLimits& limits = {}) {
+            TimeManager time_manager{*this->getCancellation(), limits};
+            return iterate(parent, depth + deep_depth, depth, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), true);
+        }
+
+        /// @brief Performs the minimax algorithm at a leaf of another search, e.g. below the shallow depth of an ExtendedSearch.
+        /// The soft deadline and the stability stop only concern the iterations at the root, leaves run until their depth or the hard limits.
+        Result searchLeaf(const State& parent, const uint32_t depth, double alpha, double beta) {
+            return iterate(parent, depth, 0, alpha, beta, false);
+        }
+
+        // deepest iteration that the last call completed
+        uint32_t completed_depth{0};
+
+    private:
+        /// @param depth max depth of the shallow and deep part together
+        /// @param shallow_depth max shallow depth of a search with a shallow part
+        /// @param is_root whether the search may stop early at the soft deadline or once it is stable
+        Result iterate(const State& parent, const uint32_t depth, const uint32_t shallow_depth, double alpha, double beta, const bool is_root);
+
+        /// @brief Searches a single iteration, searches with a shallow part grow it first since it decides which choices are in the result
+        Result searchIteration(const State& parent, const uint32_t iterative_depth, const uint32_t shallow_depth, const double alpha, const double beta) {
+            if constexpr (has_root_search<BaseSearch>::value) {
+                const uint32_t iteration_depth = std::min(iterative_depth, shallow_depth);
+                return BaseSearch::searchRoot(parent, iteration_depth, iterative_depth - iteration_depth);
+            } else {
+                return BaseSearch::expectiminimax(parent, iterative_depth, alpha, beta);
+            }
+        }
+
+        static double getScore(const Result& result) {
+            if constexpr (has_root_search<BaseSearch>::value) return result.score;
+            else return result;
+        }
+
+        /// @brief Best move at the root of the last iteration, searches that do not store moves in a transposition table only know the score
+        std::uint8_t getBestMove(const State& parent) const;
     };
 
-    template <typename BaseSearch>
-    typename IterativeSearch<BaseSearch>::Result IterativeSearch<BaseSearch>::expectiminimax(const State& parent, const uint32_t depth, double alpha, double beta) {
+    template <typename BaseSearch, bool ASPIRATION_WINDOWS, bool STOP_WHEN_STABLE>
+    std::uint8_t IterativeSearch<BaseSearch, ASPIRATION_WINDOWS, STOP_WHEN_STABLE>::getBestMove(const State& parent) const {
+        if constexpr (has_shared_table<BaseSearch>::value) {
+            if(const auto entry = this->getSharedTable()->probe(parent.key)) return entry->best_move;
+        }
+        return TranspositionTable::NO_MOVE;
+    }
+
+    template <typename BaseSearch, bool ASPIRATION_WINDOWS, bool STOP_WHEN_STABLE>
+    typename IterativeSearch<BaseSearch, ASPIRATION_WINDOWS, STOP_WHEN_STABLE>::Result IterativeSearch<BaseSearch, ASPIRATION_WINDOWS, STOP_WHEN_STABLE>::iterate(const State& parent, const uint32_t depth, const uint32_t shallow_depth, double alpha, double beta, const bool is_root) {
         
-        Result end_result;
-        BaseSearch::timeout.store(false);
-        std::chrono::duration<double> elapsed;
-        for (unsigned int iterative_depth = 1; iterative_depth <= depth; ++iterative_depth) {
-            try {
-                end_result = BaseSearch::expectiminimax(parent, iterative_depth, alpha, beta);
-            } catch (...) {
-                return end_result;
+        // a cancelled search stays cancelled, the static evaluation stands in until the first iteration is completed
+        Result end_result{};
+        if constexpr (has_root_search<BaseSearch>::value) end_result.score = Evaluator::getScore(parent);
+        else end_result = Evaluator::getScore(parent);
+        completed_depth = 0;
+        // cost of the last two iterations, the next one is expected to grow by the same factor
+        double last_seconds{0.0};
+        std::size_t last_nodes{0};
+        std::size_t previous_nodes{0};
+        // iterations that agreed with the last one on the best move and score
+        unsigned int stable_iterations{0};
+        [[maybe_unused]] std::uint8_t best_move{TranspositionTable::NO_MOVE};
+        // deeper iterations than the longest path of the tree repeat the last one, the shallow part is always searched
+        const uint32_t max_depth = std::min<uint32_t>(depth, std::max(shallow_depth, StateMachine::getMaxDepth(parent)));
+        for (unsigned int iterative_depth = 1; iterative_depth <= max_depth; ++iterative_depth) {
+            // the base search polls the token only every few nodes, so cancelled searches do not start another iteration
+            if(this->getCancellation()->isCancelled()) break;
+            // an iteration that cannot be finished would be thrown away, leaves are cheap enough to rely on the hard limits
+            if(is_root && iterative_depth > 1) {
+                const double branching_factor = previous_nodes ? std::max(1.0, static_cast<double>(last_nodes) / static_cast<double>(previous_nodes)) : 1.0;
+                if(!this->getCancellation()->canStartIteration(last_seconds * branching_factor, static_cast<std::size_t>(static_cast<double>(last_nodes) * branching_factor))) break;
+            }
+            const auto start = std::chrono::steady_clock::now();
+            const std::size_t nodes_before = this->node_count;
+            // results of shallower passes age, leaves share the table of the search around them and leave the aging to it
+            if constexpr (has_new_search<BaseSearch>::value) {
+                if(is_root) BaseSearch::newSearch();
+            }
+            Result result;
+            if constexpr (ASPIRATION_WINDOWS) {
+                // the last score is a good guess, a narrow window around it prunes more
+                double delta = parameters::ASPIRATION_WINDOW * (Evaluator::MAX_SCORE - Evaluator::MIN_SCORE);
+                double window_alpha = alpha;
+                double window_beta = beta;
+                if(iterative_depth > 1 && end_result >= alpha && end_result <= beta) {
+                    window_alpha = std::max(alpha, end_result - delta);
+                    window_beta = std::min(beta, end_result + delta);
+                }
+                result = BaseSearch::expectiminimax(parent, iterative_depth, window_alpha, window_beta);
+                // the side that failed is widened until the result lies inside of the window or the window is the one of the caller
+                while(!isAborted(result)) {
+                    if(result < window_alpha && window_alpha > alpha) window_alpha = std::max(alpha, result - delta);
+                    else if(result > window_beta && window_beta < beta) window_beta = std::min(beta, result + delta);
+                    else break;
+                    delta *= 2.0;
+                    result = BaseSearch::expectiminimax(parent, iterative_depth, window_alpha, window_beta);
+                }
+            } else {
+                result = searchIteration(parent, iterative_depth, shallow_depth, alpha, beta);
+            }
+            const double score = getScore(result);
+            // an aborted iteration has no score, the last completed one is used
+            if(isAborted(score)) break;
+            if constexpr (STOP_WHEN_STABLE) {
+                // searches with a shallow part return their choices, the others leave the best move in the table if they order by it
+                bool is_same_move;
+                if constexpr (has_root_search<BaseSearch>::value) {
+                    is_same_move = result.follow_ups.empty() ? end_result.follow_ups.empty()
+                        : !end_result.follow_ups.empty() && result.follow_ups[0] == end_result.follow_ups[0];
+                } else {
+                    const std::uint8_t move = getBestMove(parent);
+                    is_same_move = move == best_move;
+                    best_move = move;
+                }
+                // a score outside of the window is only a bound, the leaves of other searches mostly get such windows
+                const bool is_exact = score > alpha && score < beta;
+                // the shallow part decides which choices are in the result, they are compared once it is searched completely
+                const bool is_stable = is_root && is_exact && iterative_depth > shallow_depth + 1 && is_same_move
+                    && std::abs(score - getScore(end_result)) < parameters::STABLE_SCORE_MARGIN * (Evaluator::MAX_SCORE - Evaluator::MIN_SCORE);
+                stable_iterations = is_stable ? stable_iterations + 1 : 0;
+            }
+            end_result = result;
+            completed_depth = iterative_depth;
+            // nothing is worse than a certain loss or better than a certain win, deeper iterations cannot change the score
+            if(score <= Evaluator::MIN_SCORE || score >= Evaluator::MAX_SCORE) break;
+            if constexpr (STOP_WHEN_STABLE) {
+                if(stable_iterations + 1 >= parameters::STABLE_ITERATIONS) break;
             }
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            last_seconds = elapsed.count();
+            previous_nodes = last_nodes;
+            last_nodes = this->node_count - nodes_before;
         }
 
         return end_result;
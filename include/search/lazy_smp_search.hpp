@@ -0,0 +1,129 @@
+#pragma once
+
+#include "search/extended_search.hpp"
+#include "search/search_traits.hpp"
+#include "search/thread_pool.hpp"
+#include "search/time_manager.hpp"
+#include "search/cancellation_token.hpp"
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <mutex>
+
+namespace search{
+
+    /// @brief Runs iterative deepening of the whole search in every thread of a pool, all threads share one transposition table.
+    /// The threads do not split the tree, they only fill the table for each other. Threads with an odd index search one
+    /// iteration ahead and every thread learns its own move ordering, so the threads spread over different parts of the tree.
+    /// The result is the one of the deepest iteration that any thread completed, the search ends once the last iteration is completed.
+    template <typename BaseSearch>
+    class LazySmpSearch : public ExtendedSearch<BaseSearch> {
+        static_assert(has_shared_table<BaseSearch>::value, "Lazy SMP needs a transposition table that is shared between the threads");
+
+    public:
+        using Evaluator = typename BaseSearch::Evaluator;
+        using StateMachine = typename BaseSearch::StateMachine;
+        using State = typename StateMachine::State;
+        using Event = typename StateMachine::Event;
+        using Result = typename LazySmpSearch<BaseSearch>::Result;
+
+        using ExtendedSearch<BaseSearch>::ExtendedSearch;
+
+        // number of threads every search uses
+        static std::atomic<unsigned int> free_threads;
+
+        /// @brief Performs the minimax algorithm with threading
+        /// @param parent state to evaluate
+        /// @param depth max shallow depth to evaluate
+        /// @param deep_depth max deep depth to evaluate
+        /// @param limits return the deepest completed iteration after the time or node limit was reached
+        /// @return best score that the parent gets
+        Result expectiminimax(const State& parent, const uint32_t depth, const uint32_t deep_depth = 0, const SearchLimits& limits = {});
+
+    private:
+        using Worker = ExtendedSearch<BaseSearch>;
+
+        std::unique_ptr<ThreadPool> pool;
+        // one search per thread of the pool, they only live for a single call
+        std::vector<Worker> workers;
+    };
+
+    template <typename BaseSearch>
+    std::atomic<unsigned int> LazySmpSearch<BaseSearch>::free_threads{1};
+
+    template <typename BaseSearch>
+    typename LazySmpSearch<BaseSearch>::Result LazySmpSearch<BaseSearch>::expectiminimax(const State& parent, const uint32_t depth, const uint32_t deep_depth, const SearchLimits& limits) {
+        if (StateMachine::isFinished(parent) || !depth) {
+            return ExtendedSearch<BaseSearch>::expectiminimax(parent, depth, deep_depth);
+        }
+
+        // the threads are kept for later searches
+        const std::size_t thread_count = std::max(free_threads.load(), 1u);
+        if(!pool || pool->getThreadCount() != thread_count) pool = std::make_unique<ThreadPool>(thread_count);
+        workers.clear();
+        for(std::size_t index = 0; index < thread_count; ++index) {
+            workers.push_back(Worker(this->getSharedTable()));
+            // cancelling this search stops all workers
+            workers.back().setCancellation(this->getCancellation());
+        }
+        if constexpr (has_new_search<BaseSearch>::value) this->newSearch();
+
+        // the tree ends before the maximum depth, deeper iterations would repeat the same search
+        const uint32_t last_iteration = std::min(depth + deep_depth, std::max(depth, StateMachine::getMaxDepth(parent)));
+        // deepest result of all threads
+        struct {
+            std::mutex mutex;
+            uint32_t iteration{0};
+            Result result;
+            bool is_stopped{false};
+        } deepest;
+
+        {
+            TimeManager time_manager{*this->getCancellation(), limits};
+            const auto iterate = [this, &parent, &deepest, &time_manager, depth, last_iteration](const std::size_t index) {
+                Worker& worker = workers[index];
+                uint32_t iteration{0};
+                while(true) {
+                    {
+                        std::lock_guard<std::mutex> lock(deepest.mutex);
+                        if(deepest.is_stopped) return;
+                        // iterations that another thread completed are skipped
+                        iteration = std::min<uint32_t>(std::max(iteration, deepest.iteration) + 1 + index % 2, last_iteration);
+                    }
+                    // the shallow part grows first, it decides which choices are in the result
+                    const uint32_t iteration_depth = std::min(iteration, depth);
+                    const Result result = worker.expectiminimax(parent, iteration_depth, iteration - iteration_depth);
+                    std::lock_guard<std::mutex> lock(deepest.mutex);
+                    if(isAborted(result.score)) {
+                        deepest.is_stopped = true;
+                        return;
+                    }
+                    if(iteration > deepest.iteration) {
+                        deepest.iteration = iteration;
+                        deepest.result = result;
+                    }
+                    if(iteration == last_iteration) {
+                        // the other threads are aborted, their iterations are shallower or repeat this one
+                        deepest.is_stopped = true;
+                        time_manager.stop();
+                        return;
+                    }
+                }
+            };
+            ThreadPool::TaskGroup helpers{*pool};
+            for(std::size_t index = 1; index < thread_count; ++index) helpers.spawn(iterate, index);
+            iterate(0);
+            helpers.wait();
+        }
+
+        for(const auto& worker : workers) {
+            this->node_count += worker.node_count;
+            this->skipped_children += worker.skipped_children;
+            this->addTableStatistics(worker.getTableStatistics());
+        }
+        workers.clear();
+        return deepest.result;
+    }
+}
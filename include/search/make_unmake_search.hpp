@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cassert>
+#include <limits>
+#include "parameters.hpp"
+#include "search/search_traits.hpp"
+#include "search/cancellation_token.hpp"
+
+namespace search{
+
+    /// @brief Same search as Search but it modifies a single state in place
+    /// with apply/undo instead of allocating every child on the heap
+    template <typename StateMachineType, typename EvaluatorType>
+    class MakeUnmakeSearch {
+    public:
+        using StateMachine = StateMachineType;
+        using Evaluator = EvaluatorType;
+        using State = typename StateMachine::State;
+        using Event = typename StateMachine::Event;
+        using MoveList = typename StateMachine::MoveList;
+        using Result = double;
+
+        // number of visited nodes
+        std::size_t node_count{0};
+
+        // number of moves that were never applied due to pruning
+        std::size_t skipped_children{0};
+
+        /// @brief Token that stops this search, threads that work on the same search share it
+        std::shared_ptr<CancellationToken> getCancellation() const { return cancellation; }
+
+        /// @brief Lets another token stop this search, e.g. the one of the search this search works for
+        void setCancellation(std::shared_ptr<CancellationToken> token) { cancellation = std::move(token); }
+
+        /// @brief Performs the minimax algorithm only to find the score of the parent
+        /// @param parent state to evaluate
+        /// @param depth max depth to evaluate
+        /// @param alpha lower bound for alpha-beta pruning
+        /// @param beta upper bound for alpha-beta pruning
+        /// @return best score that the parent gets
+        double expectiminimax(const State& parent, const uint32_t depth, double alpha = -std::numeric_limits<double>::infinity(), double beta = std::numeric_limits<double>::infinity());
+
+    private:
+        double expectiminimaxInPlace(State& state, const uint32_t depth, double alpha, double beta);
+
+        std::shared_ptr<CancellationToken> cancellation{std::make_shared<CancellationToken>()};
+        // nodes that were already reported to the token
+        std::size_t polled_nodes{0};
+
+        /// @brief Reports the nodes since the last poll to the token
+        /// @return Whether the search is cancelled
+        bool poll() {
+            const bool is_cancelled = cancellation->poll(node_count - polled_nodes);
+            polled_nodes = node_count;
+            return is_cancelled;
+        }
+    };
+
+    template <typename StateMachineType, typename EvaluatorType>
+    double MakeUnmakeSearch<StateMachineType, EvaluatorType>::expectiminimax(const State& parent, const uint32_t depth, double alpha, double beta){
+        // every move is undone, even when the search is aborted
+        State state{parent};
+        return expectiminimaxInPlace(state, depth, alpha, beta);
+    }
+
+    template <typename StateMachineType, typename EvaluatorType>
+    double MakeUnmakeSearch<StateMachineType, EvaluatorType>::expectiminimaxInPlace(State& state, const uint32_t depth, double alpha, double beta){
+        ++node_count;
+        // the token is only polled every few nodes, an aborted search unwinds with a sentinel instead of a score
+        if(node_count % parameters::CANCELLATION_CHECK_INTERVAL == 0 && poll()) return ABORTED_SCORE;
+
+        // solved states are terminal nodes as well, even below the depth
+        if constexpr (has_exact_score<Evaluator>::value) {
+            if(const auto score = Evaluator::getExactScore(state)) return *score;
+        }
+        // terminal nodes
+        if(StateMachine::isFinished(state) || !depth) {
+            return Evaluator::getScore(state);
+        }
+        // get moves:
+        MoveList moves;
+        StateMachine::generateMoves(state, moves);
+        assert(!moves.empty());
+        if(moves.size() == 1) {
+            // skip single childs in depth computation
+            const auto record = StateMachine::apply(state, moves[0]);
+            const double result = expectiminimaxInPlace(state, depth, alpha, beta);
+            StateMachine::undo(state, record);
+            return result;
+        }
+        const bool is_evaluation = StateMachine::isEvaluationPhase(state.next_event);
+
+        if(is_evaluation) {
+            const bool is_player_turn = StateMachine::isPlayerTurn(state);
+            double end_result = is_player_turn ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+
+            for(std::size_t index = 0; index < moves.size(); ++index) {
+                const auto record = StateMachine::apply(state, moves[index]);
+                const auto result = expectiminimaxInPlace(state, depth-1, alpha, beta);
+                StateMachine::undo(state, record);
+                if(isAborted(result)) return result;
+                if(is_player_turn) {
+                    if (result > end_result) {
+                        end_result = result;
+                    }
+                    // alpha-beta pruning
+                    if (end_result > beta) {
+                        skipped_children += moves.size() - index - 1;
+                        break;
+                    }
+                    alpha = std::max(alpha, end_result);
+                } else {
+                    if (result < end_result) {
+                        end_result = result;
+                    }
+                    // alpha-beta pruning
+                    if (end_result < alpha) {
+                        skipped_children += moves.size() - index - 1;
+                        break;
+                    }
+                    beta = std::min(beta, end_result);
+                }
+            }
+            return end_result;
+        } else {
+            // random event happens
+            double end_result = 0.0;
+            double total_probability = 0.0;
+            for( const auto& move : moves ) {
+                // accumulate results
+                const auto record = StateMachine::apply(state, move);
+                // the window bounds the weighted sum, not single outcomes, so outcomes are searched without one
+                const double result = expectiminimaxInPlace(state, depth-1, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity());
+                StateMachine::undo(state, record);
+                if(isAborted(result)) return result;
+                total_probability += move.probability;
+                end_result += move.probability * result;
+            }
+            assert(std::abs(total_probability - 1.0) < parameters::EPSILON);
+            return end_result;
+        }
+    }
+}
\ No newline at end of file
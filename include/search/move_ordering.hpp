@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <algorithm>
+#include "engine/objects/state.hpp"
+#include "engine/state_machine.hpp"
+
+namespace search{
+
+    /// @brief History and killer heuristics that order the children of decision nodes.
+    /// Both heuristics learn from the moves that caused cutoffs earlier in the same search.
+    /// @tparam USE_HISTORY score moves by how often they caused cutoffs in similar situations
+    /// @tparam USE_KILLERS try the last moves that caused a cutoff at the same depth first
+    /// @tparam USE_TABLE_MOVE searches with a transposition table try the best move of an earlier search first
+    template <bool USE_HISTORY = true, bool USE_KILLERS = true, bool USE_TABLE_MOVE = false>
+    class MoveOrdering {
+    public:
+        static constexpr bool ENABLED{USE_HISTORY || USE_KILLERS};
+        static constexpr bool TABLE_MOVE{USE_TABLE_MOVE};
+
+        /// @brief Rates a move, better moves get higher scores
+        /// @param state state in which the move is decided
+        /// @param event decision to rate
+        /// @param depth remaining search depth
+        std::uint32_t getScore(const engine::State& state, const engine::Event& event, const std::uint32_t depth) const {
+            if constexpr (USE_KILLERS) {
+                const auto& killers = killer_moves[std::min<std::size_t>(depth, MAX_DEPTH - 1)];
+                if(event == killers[0]) return KILLER_SCORE + 1;
+                if(event == killers[1]) return KILLER_SCORE;
+            }
+            if constexpr (USE_HISTORY) return history[getHistoryIndex(state, event)];
+            return 0;
+        }
+
+        /// @brief Remembers a move that caused a cutoff
+        /// @param state state in which the move was decided
+        /// @param event decision that caused the cutoff
+        /// @param depth remaining search depth
+        void addCutoff(const engine::State& state, const engine::Event& event, const std::uint32_t depth) {
+            if constexpr (USE_KILLERS) {
+                auto& killers = killer_moves[std::min<std::size_t>(depth, MAX_DEPTH - 1)];
+                if(!(event == killers[0])) {
+                    killers[1] = killers[0];
+                    killers[0] = event;
+                }
+            }
+            if constexpr (USE_HISTORY) {
+                auto& value = history[getHistoryIndex(state, event)];
+                // deep cutoffs save more nodes, saturate instead of overflowing into the killer scores
+                value = std::min<std::uint32_t>(value + depth * depth, KILLER_SCORE - 1);
+            }
+        }
+
+    private:
+        static constexpr std::size_t MAX_DEPTH{64};
+        static constexpr std::uint32_t KILLER_SCORE{1u << 30};
+        // shooting self, shooting the opponent and one entry per item
+        static constexpr std::size_t DECISIONS{2 + static_cast<std::size_t>(engine::Item::Count)};
+        static constexpr std::size_t ROUNDS{9};
+        static constexpr std::size_t KNOWLEDGE{3};
+
+        // the situation is described by the side to move, the remaining rounds and what that side knows about the next round
+        static std::size_t getHistoryIndex(const engine::State& state, const engine::Event& event) {
+            std::size_t decision{0};
+            if(event.action == engine::Action::ShootOther) decision = 1;
+            else if(event.action == engine::Action::UseItem) decision = 2 + static_cast<std::size_t>(event.item);
+            auto knowledge = event.is_player_turn ? state.shotgun.getPlayerKnowledgeOfRound() : state.shotgun.getDealerKnowledgeOfRound();
+            if(state.inverter_used && knowledge != engine::Round::Unknown) {
+                knowledge = knowledge == engine::Round::BlankRound ? engine::Round::LiveRound : engine::Round::BlankRound;
+            }
+            const std::size_t rounds = std::min<std::size_t>(state.shotgun.getRemainingRounds(), ROUNDS - 1);
+            return ((event.is_player_turn * DECISIONS + decision) * ROUNDS + rounds) * KNOWLEDGE + static_cast<std::size_t>(knowledge);
+        }
+
+        std::array<std::uint32_t, 2 * DECISIONS * ROUNDS * KNOWLEDGE> history{};
+        // no decision is ever an Evaluating event, so the default event never matches
+        std::array<std::array<engine::Event, 2>, MAX_DEPTH> killer_moves{};
+    };
+
+    // default of the searches, the heuristics make every search of the performance tests visit more nodes in this game
+    using NoMoveOrdering = MoveOrdering<false, false>;
+
+    using engine::sortByScore;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "search/cancellation_token.hpp"
+
+namespace search{
+
+    /// @brief Searches a child of a decision node that is not the first one (principal variation search).
+    /// A null window at the best score so far only shows whether the child is better. Only children that are better
+    /// are searched again with the full window, the other results are valid bounds.
+    /// @param search searches the child with the given alpha and beta
+    /// @param is_player_turn whether the decision node maximizes
+    /// @param alpha lower bound of the decision node, already raised by the earlier children
+    /// @param beta upper bound of the decision node, already lowered by the earlier children
+    /// @return score of the child within the closed window or a bound outside of it
+    template <typename SearchChild>
+    double searchWithNullWindow(const SearchChild& search, const bool is_player_turn, const double alpha, const double beta) {
+        const double bound = is_player_turn ? alpha : beta;
+        const double result = search(bound, bound);
+        if(isAborted(result)) return result;
+        // no better than the bound or already outside of the window
+        if(is_player_turn ? result <= alpha || result > beta : result >= beta || result < alpha) return result;
+        return search(alpha, beta);
+    }
+}
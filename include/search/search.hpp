@@ -1,14 +1,18 @@
 #pragma once
 
-#include <deque>
+#include <atomic>
 #include <memory>
 #include <cassert>
-#include <stdexcept>
 #include <limits>
 #include "parameters.hpp"
+#include "search/search_traits.hpp"
+#include "search/cancellation_token.hpp"
+#include "search/move_ordering.hpp"
+#include "search/chance_pruning.hpp"
+#include "search/principal_variation.hpp"
 
 namespace search{
-    template <typename StateMachineType, typename EvaluatorType>
+    template <typename StateMachineType, typename EvaluatorType, typename MoveOrderingType = NoMoveOrdering, ChancePruning CHANCE_PRUNING_MODE = ChancePruning::Star1, bool PRINCIPAL_VARIATION_SEARCH = false>
     class Search {
     public:
         using StateMachine = StateMachineType;
@@ -16,9 +20,24 @@ namespace search{
         using State = typename StateMachine::State;
         using Event = typename StateMachine::Event;
         using Result = double;
+        using MoveOrdering = MoveOrderingType;
+        using ChanceWindow = search::ChanceWindow<StateMachine::MoveList::CAPACITY>;
+        static constexpr ChancePruning CHANCE_PRUNING{CHANCE_PRUNING_MODE};
 
-        // set the timeout to stop evaluation immediately
-        static std::atomic<bool> timeout;
+        // number of visited nodes
+        std::size_t node_count{0};
+
+        // number of children that were never created due to pruning
+        std::size_t skipped_children{0};
+
+        // learns which decisions cause cutoffs
+        MoveOrdering move_ordering;
+
+        /// @brief Token that stops this search, threads that work on the same search share it
+        std::shared_ptr<CancellationToken> getCancellation() const { return cancellation; }
+
+        /// @brief Lets another token stop this search, e.g. the one of the search this search works for
+        void setCancellation(std::shared_ptr<CancellationToken> token) { cancellation = std::move(token); }
 
         /// @brief Performs the minimax algorithm only to find the score of the parent
         /// @param parent state to evaluate
@@ -27,47 +46,92 @@ namespace search{
         /// @param beta upper bound for alpha-beta pruning
         /// @return best score that the parent gets
         double expectiminimax(const State& parent, const uint32_t depth, double alpha = -std::numeric_limits<double>::infinity(), double beta = std::numeric_limits<double>::infinity());
-    };
 
-    template <typename StateMachineType, typename EvaluatorType>
-    std::atomic<bool> Search<StateMachineType, EvaluatorType>::timeout{false};
+        /// @brief Searches only the first decision of an outcome of a random event (Star2).
+        /// A single decision of the maximizing side bounds the outcome from below, one of the minimizing side from above.
+        /// @param outcome child of a chance node
+        /// @param depth depth the outcome would be searched with
+        /// @param window window of the chance node that receives the bound
+        /// @param index index of the outcome in the window
+        void probe(const State& outcome, const uint32_t depth, ChanceWindow& window, const std::size_t index);
 
-    template <typename StateMachineType, typename EvaluatorType>
-    double Search<StateMachineType, EvaluatorType>::expectiminimax(const State& parent, const uint32_t depth, double alpha, double beta){
-        if(timeout) throw std::runtime_error("timeout");
+    private:
+        std::shared_ptr<CancellationToken> cancellation{std::make_shared<CancellationToken>()};
+        // nodes that were already reported to the token
+        std::size_t polled_nodes{0};
 
+        /// @brief Reports the nodes since the last poll to the token
+        /// @return Whether the search is cancelled
+        bool poll() {
+            const bool is_cancelled = cancellation->poll(node_count - polled_nodes);
+            polled_nodes = node_count;
+            return is_cancelled;
+        }
+    };
+
+    template <typename StateMachineType, typename EvaluatorType, typename MoveOrderingType, ChancePruning CHANCE_PRUNING_MODE, bool PRINCIPAL_VARIATION_SEARCH>
+    double Search<StateMachineType, EvaluatorType, MoveOrderingType, CHANCE_PRUNING_MODE, PRINCIPAL_VARIATION_SEARCH>::expectiminimax(const State& parent, const uint32_t depth, double alpha, double beta){
+        ++node_count;
+        // the token is only polled every few nodes, an aborted search unwinds with a sentinel instead of a score
+        if(node_count % parameters::CANCELLATION_CHECK_INTERVAL == 0 && poll()) return ABORTED_SCORE;
+
+        // solved states are terminal nodes as well, even below the depth
+        if constexpr (has_exact_score<Evaluator>::value) {
+            if(const auto score = Evaluator::getExactScore(parent)) return *score;
+        }
         // terminal nodes
         if(StateMachine::isFinished(parent) || !depth) {
             return Evaluator::getScore(parent);
         }
-        // get children:
-        auto children = StateMachine::getChildStates(parent);
-        assert(!children.empty());
+        // get children lazily:
+        typename StateMachine::ChildGenerator children{parent};
+        assert(children.hasNext());
         if(children.size() == 1) {
             // skip single childs in depth computation
-            return expectiminimax(*children.front(), depth, alpha, beta);
+            return expectiminimax(children.next(), depth, alpha, beta);
         }
         const bool is_evaluation = StateMachine::isEvaluationPhase(parent.next_event);
 
         if(is_evaluation) {
+            if constexpr (MoveOrdering::ENABLED) {
+                children.sort([this, &parent, depth](const auto& move) { return move_ordering.getScore(parent, move.event, depth); });
+            }
             const bool is_player_turn = StateMachine::isPlayerTurn(parent);
             double end_result = is_player_turn ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
 
-            for( auto& child : children ) {
-                const auto result = expectiminimax(*child, depth-1, alpha, beta);
+            bool is_first{true};
+            while(children.hasNext()) {
+                const auto child = children.next();
+                double result;
+                if constexpr (PRINCIPAL_VARIATION_SEARCH) {
+                    const auto searchChild = [this, &child, depth](const double child_alpha, const double child_beta) { return expectiminimax(child, depth-1, child_alpha, child_beta); };
+                    result = is_first ? searchChild(alpha, beta) : searchWithNullWindow(searchChild, is_player_turn, alpha, beta);
+                    is_first = false;
+                } else {
+                    result = expectiminimax(child, depth-1, alpha, beta);
+                }
+                if(isAborted(result)) return result;
                 if(is_player_turn) {
                     if (result > end_result) {
                         end_result = result;
                     }
                     // alpha-beta pruning
-                    if (end_result > beta) break;
+                    if (end_result > beta) {
+                        skipped_children += children.remaining();
+                        if constexpr (MoveOrdering::ENABLED) move_ordering.addCutoff(parent, children.getMove().event, depth);
+                        break;
+                    }
                     alpha = std::max(alpha, end_result);
                 } else {
                     if (result < end_result) {
                         end_result = result;
                     }
                     // alpha-beta pruning
-                    if (end_result < alpha) break;
+                    if (end_result < alpha) {
+                        skipped_children += children.remaining();
+                        if constexpr (MoveOrdering::ENABLED) move_ordering.addCutoff(parent, children.getMove().event, depth);
+                        break;
+                    }
                     beta = std::min(beta, end_result);
                 }
             }
@@ -76,14 +140,70 @@ namespace search{
             // random event happens
             double end_result = 0.0;
             double total_probability = 0.0;
-            for( const auto& child : children ) {
-                // accumulate results
-                const double result = expectiminimax(*child, depth-1, alpha, beta);
-                total_probability += child->probability;
-                end_result += child->probability * result;
+            if constexpr (CHANCE_PRUNING == ChancePruning::None) {
+                while(children.hasNext()) {
+                    // accumulate results
+                    const auto child = children.next();
+                    // the window bounds the weighted sum, not single outcomes, so outcomes are searched without one
+                    const double result = expectiminimax(child, depth-1, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity());
+                    if(isAborted(result)) return result;
+                    total_probability += child.probability;
+                    end_result += child.probability * result;
+                }
+            } else {
+                ChanceWindow window{alpha, beta, Evaluator::MIN_SCORE, Evaluator::MAX_SCORE};
+                for(const auto& move : children.getMoves()) window.addOutcome(move.probability);
+                if constexpr (CHANCE_PRUNING == ChancePruning::Star2) {
+                    typename StateMachine::ChildGenerator outcomes{parent};
+                    while(outcomes.hasNext()) {
+                        const auto outcome = outcomes.next();
+                        probe(outcome, depth-1, window, outcomes.getMoveIndex());
+                        if(const auto cut = window.getCut()) {
+                            skipped_children += children.size();
+                            return *cut;
+                        }
+                    }
+                }
+                while(children.hasNext()) {
+                    // accumulate results
+                    const auto child = children.next();
+                    const std::size_t index = children.getMoveIndex();
+                    // the window of an outcome is as wide as the other outcomes allow (Star1)
+                    const double result = expectiminimax(child, depth-1, window.getAlpha(index), window.getBeta(index));
+                    if(isAborted(result)) return result;
+                    if(const auto cut = window.setScore(index, result)) {
+                        skipped_children += children.remaining();
+                        return *cut;
+                    }
+                    total_probability += child.probability;
+                    end_result += child.probability * result;
+                }
             }
             assert(std::abs(total_probability - 1.0) < parameters::EPSILON);
             return end_result;
         }
     }
+
+    template <typename StateMachineType, typename EvaluatorType, typename MoveOrderingType, ChancePruning CHANCE_PRUNING_MODE, bool PRINCIPAL_VARIATION_SEARCH>
+    void Search<StateMachineType, EvaluatorType, MoveOrderingType, CHANCE_PRUNING_MODE, PRINCIPAL_VARIATION_SEARCH>::probe(const State& outcome, const uint32_t depth, ChanceWindow& window, const std::size_t index){
+        // only decisions that are searched deeper can be probed
+        if(StateMachine::isFinished(outcome) || !depth || !StateMachine::isEvaluationPhase(outcome.next_event)) return;
+        typename StateMachine::ChildGenerator children{outcome};
+        if(children.size() == 1) return;
+        // probe the decision the full search would try first
+        if constexpr (MoveOrdering::ENABLED) {
+            children.sort([this, &outcome, depth](const auto& move) { return move_ordering.getScore(outcome, move.event, depth); });
+        }
+        if(StateMachine::isPlayerTurn(outcome)) {
+            const double target = window.getBeta(index);
+            if(!window.isReachable(target)) return;
+            const double result = expectiminimax(children.next(), depth-1, target, target);
+            if(result >= target) window.setLower(index, result);
+        } else {
+            const double target = window.getAlpha(index);
+            if(!window.isReachable(target)) return;
+            const double result = expectiminimax(children.next(), depth-1, target, target);
+            if(result <= target) window.setUpper(index, result);
+        }
+    }
 }
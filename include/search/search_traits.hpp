@@ -0,0 +1,63 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+#include "search/chance_pruning.hpp"
+
+namespace search{
+    // detects searches that keep results between iterations
+    template <typename Search, typename = void>
+    struct has_new_search : std::false_type {};
+
+    template <typename Search>
+    struct has_new_search<Search, std::void_t<decltype(std::declval<Search&>().newSearch())>> : std::true_type {};
+
+    // detects searches that search the leaves of another search differently than a root
+    template <typename Search, typename = void>
+    struct has_leaf_search : std::false_type {};
+
+    template <typename Search>
+    struct has_leaf_search<Search, std::void_t<decltype(std::declval<Search&>().searchLeaf(std::declval<const typename Search::StateMachine::State&>(), 0u, 0.0, 0.0))>> : std::true_type {};
+
+    // detects searches with a shallow part that search their root within the limits set by a search around them, e.g. ThreadedSearch
+    template <typename Search, typename = void>
+    struct has_root_search : std::false_type {};
+
+    template <typename Search>
+    struct has_root_search<Search, std::void_t<decltype(std::declval<Search&>().searchRoot(std::declval<const typename Search::StateMachine::State&>(), 0u, 0u))>> : std::true_type {};
+
+    // detects searches whose transposition table can be shared with other threads
+    template <typename Search, typename = void>
+    struct has_shared_table : std::false_type {};
+
+    template <typename Search>
+    struct has_shared_table<Search, std::void_t<decltype(std::declval<const Search&>().getSharedTable())>> : std::true_type {};
+
+    // detects searches that report transposition table statistics
+    template <typename Search, typename = void>
+    struct has_table_statistics : std::false_type {};
+
+    template <typename Search>
+    struct has_table_statistics<Search, std::void_t<decltype(std::declval<const Search&>().getTableStatistics())>> : std::true_type {};
+
+    // detects evaluators that know the exact score of some states, e.g. from a solved endgame
+    template <typename Evaluator, typename = void>
+    struct has_exact_score : std::false_type {};
+
+    template <typename Evaluator>
+    struct has_exact_score<Evaluator, std::void_t<decltype(&Evaluator::getExactScore)>> : std::true_type {};
+
+    // detects searches that order the children of decision nodes by heuristics
+    template <typename Search, typename = void>
+    struct has_move_ordering : std::false_type {};
+
+    template <typename Search>
+    struct has_move_ordering<Search, std::void_t<typename Search::MoveOrdering>> : std::true_type {};
+
+    // chance pruning of a search, searches without one search every outcome with an open window
+    template <typename Search, typename = void>
+    struct chance_pruning_of : std::integral_constant<ChancePruning, ChancePruning::None> {};
+
+    template <typename Search>
+    struct chance_pruning_of<Search, std::void_t<decltype(Search::CHANCE_PRUNING)>> : std::integral_constant<ChancePruning, Search::CHANCE_PRUNING> {};
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cassert>
+#include <exception>
+#include <condition_variable>
+#include "search/inline_deque.hpp"
+
+namespace search{
+
+    /// @brief Persistent worker threads that balance their load by stealing tasks from each other.
+    /// Every thread owns a queue. It pushes new tasks to the back and takes its next task from the back, so it works depth first.
+    /// Idle threads steal from the front of the other queues, where the oldest and usually largest tasks wait.
+    /// A thread that waits for a group of tasks executes tasks in the meantime, so tasks may split their work again.
+    class ThreadPool {
+    public:
+        class TaskGroup;
+
+        /// @param thread_count number of threads that execute tasks, including the thread that uses the pool
+        explicit ThreadPool(const std::size_t thread_count);
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        std::size_t getThreadCount() const { return thread_count; }
+
+        /// @brief Index of the calling thread, all threads outside of the pool share index 0
+        std::size_t getThreadIndex() const;
+
+    private:
+        struct Task{
+            void (*function)(void* context, const std::size_t index){nullptr};
+            void* context{nullptr};
+            std::size_t index{0};
+            TaskGroup* group{nullptr};
+        };
+
+        struct alignas(64) Queue{
+            std::mutex mutex;
+            InlineDeque<Task, 256> tasks;
+        };
+
+        void push(const Task& task);
+
+        /// @brief Executes a task of the own queue or steals one
+        /// @return False if there was no task
+        bool runNext();
+
+        void work(const std::size_t index);
+
+        static void execute(const Task& task);
+
+        std::size_t thread_count;
+        std::unique_ptr<Queue[]> queues;
+        std::vector<std::thread> threads;
+        // tasks in all queues, idle threads sleep while there are none
+        std::atomic<std::size_t> queued_tasks{0};
+        std::mutex sleep_mutex;
+        std::condition_variable wake_up;
+        bool stopping{false};
+    };
+
+    /// @brief Tasks that are waited for together
+    class ThreadPool::TaskGroup {
+    public:
+        explicit TaskGroup(ThreadPool& pool) : pool(pool) {}
+        ~TaskGroup() { assert(!pending.load()); }
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        /// @brief Schedules function(index), the function must stay alive until wait returned
+        template <typename Function>
+        void spawn(Function& function, const std::size_t index) {
+            pending.fetch_add(1, std::memory_order_relaxed);
+            Task task;
+            task.function = [](void* context, const std::size_t task_index) { (*static_cast<Function*>(context))(task_index); };
+            task.context = const_cast<void*>(static_cast<const void*>(&function));
+            task.index = index;
+            task.group = this;
+            pool.push(task);
+        }
+
+        /// @brief Executes tasks until every task of the group finished
+        /// @throws The first exception thrown by a task of the group
+        void wait();
+
+    private:
+        friend class ThreadPool;
+
+        ThreadPool& pool;
+        std::atomic<std::size_t> pending{0};
+        std::mutex exception_mutex;
+        std::exception_ptr exception;
+    };
+}
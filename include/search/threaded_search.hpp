@@ -1,162 +1,356 @@
 #pragma once
 
 #include "search/extended_search.hpp"
+#include "search/search_traits.hpp"
+#include "search/thread_pool.hpp"
+#include "search/move_ordering.hpp"
+#include "search/chance_pruning.hpp"
+#include "search/time_manager.hpp"
+#include "search/cancellation_token.hpp"
 
 #include <vector>
 #include <memory>
-#include <queue>
-#include <thread>
-#include <future>
+#include <array>
+#include <numeric>
 #include <algorithm>
-#include <iostream>
+#include <mutex>
+#include <optional>
+#include <limits>
+#include <cmath>
 
 namespace search{
-    template <typename BaseSearch>
+
+    /// @brief Splits the search between the threads of a work-stealing pool.
+    /// Decision nodes with enough remaining depth search their eldest child first to get a good window
+    /// and then hand the younger siblings to the pool (Young Brothers Wait). Nodes below the root split again,
+    /// so threads that run out of work steal subtrees of any size until the search is finished.
+    /// With SPLIT_OUTCOMES chance nodes with enough remaining depth hand all of their outcomes to the pool as well.
+    template <typename BaseSearch, bool SPLIT_OUTCOMES = true>
     class ThreadedSearch : public ExtendedSearch<BaseSearch> {
     public:
         using Evaluator = typename BaseSearch::Evaluator;
         using StateMachine = typename BaseSearch::StateMachine;
         using State = typename StateMachine::State;
         using Event = typename StateMachine::Event;
-        using Result = typename ThreadedSearch<BaseSearch>::Result;
+        using Result = typename ExtendedSearch<BaseSearch>::Result;
+
+        using ExtendedSearch<BaseSearch>::ExtendedSearch;
 
+        // number of threads every search uses
         static std::atomic<unsigned int> free_threads;
 
         /// @brief Performs the minimax algorithm with threading
         /// @param parent state to evaluate
         /// @param depth max shallow depth to evaluate
         /// @param deep_depth max deep depth to evaluate
-        /// @param time_limit abort evaluation after the time limit was reached
-        /// @return vector of children scores
-        std::vector<Result> expectiminimaxThreaded(const std::vector<std::unique_ptr<State>>& children, const uint32_t depth, const uint32_t deep_depth = 0, const double time_limit = parameters::TIME_LIMIT);
+        /// @param limits abort evaluation after the time or node limit was reached
+        /// @return best score that the parent gets, an aborted score if a limit was reached and the base search could not provide a result
+        Result expectiminimax(const State& parent, const uint32_t depth, const uint32_t deep_depth = 0, const SearchLimits& limits = {});
 
-        /// @brief Performs the minimax algorithm with threading
-        /// @param parent state to evaluate
-        /// @param depth max shallow depth to evaluate
-        /// @param deep_depth max deep depth to evaluate
-        /// @param time_limit abort evaluation after the time limit was reached
-        /// @return best score that the parent gets
-        Result expectiminimaxSingleLayer(const State& parent, const std::vector<std::unique_ptr<State>>& children, const std::vector<Result>& results);
+        /// @brief Performs the minimax algorithm with threading within the limits that are already set on the cancellation token,
+        /// e.g. by an iterative search around this one
+        Result searchRoot(const State& parent, const uint32_t depth, const uint32_t deep_depth);
 
-        /// @brief Performs the minimax algorithm with threading
-        /// @param parent state to evaluate
-        /// @param depth max shallow depth to evaluate
-        /// @param deep_depth max deep depth to evaluate
-        /// @param time_limit abort evaluation after the time limit was reached
-        /// @return best score that the parent gets
-        Result expectiminimax(const State& parent, const uint32_t depth, const uint32_t deep_depth = 0, const double time_limit = parameters::TIME_LIMIT);
+    private:
+        using Worker = ExtendedSearch<BaseSearch>;
+        using ChanceWindow = typename Worker::ChanceWindow;
+        static constexpr std::size_t CAPACITY{StateMachine::MoveList::CAPACITY};
+
+        /// @brief Creates the search of a worker thread, all workers share the cancellation token and the transposition table if there is one
+        Worker createWorker() const;
+
+        /// @brief Search of the calling thread
+        Worker& getWorker() { return workers[pool->getThreadIndex()]; }
+
+        /// @brief Searches a node like ExtendedSearch, but splits it between the threads if enough depth is left
+        Result splitSearch(const State& parent, const uint32_t depth, const uint32_t deep_depth, double alpha, double beta);
+
+        /// @brief Searches all outcomes of a random event in parallel and sums their scores weighted by probability
+        /// @param children outcomes of the random event
+        /// @param depth shallow depth of the outcomes
+        /// @param deep_depth deep depth of the outcomes
+        Result splitOutcomes(const arena::Span<State>& children, const uint32_t depth, const uint32_t deep_depth, const double alpha, const double beta);
+
+        std::unique_ptr<ThreadPool> pool;
+        // one search per thread of the pool, they only live for a single call
+        std::vector<Worker> workers;
     };
 
-    template <typename BaseSearch>
-    std::atomic<unsigned int> ThreadedSearch<BaseSearch>::free_threads{1};
-
-    template <typename BaseSearch>
-    std::vector<typename ThreadedSearch<BaseSearch>::Result> ThreadedSearch<BaseSearch>::expectiminimaxThreaded(const std::vector<std::unique_ptr<State>>& children, const uint32_t depth, const uint32_t deep_depth, const double time_limit) {
-        const std::size_t number_of_children = children.size();
-
-        std::vector<std::future<Result>> futures;
-        std::vector<Result> results(number_of_children);
-        std::size_t next_future_index = 0;
-        std::vector<bool> result_ready(number_of_children, false);
-        auto start = std::chrono::steady_clock::now();
-        // wait short for quickly finished results
-        while (true) {
-            // add as many futures as possible
-            unsigned int expected = free_threads.load();
-            while(free_threads.compare_exchange_weak(expected, expected - 1) && (next_future_index < number_of_children)) {
-                auto& child = children[next_future_index];
-                futures.push_back(std::async(std::launch::async, [this ,&child, depth, deep_depth]() {
-                    Result result;
-                    {
-                        ExtendedSearch<BaseSearch> single_thread_search;
-                        result = single_thread_search.expectiminimax(*child, depth - 1, deep_depth);
-                        // scope results in a clearing of memory when this is finished
-                    }
-                    return result;
-                }));
-                ++next_future_index;
-                expected = free_threads.load();
-            }
+    template <typename BaseSearch, bool SPLIT_OUTCOMES>
+    std::atomic<unsigned int> ThreadedSearch<BaseSearch, SPLIT_OUTCOMES>::free_threads{1};
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(10)); // short timeout if search is quick
-
-            // check future status
-            for (std::size_t index = 0; index < number_of_children; ++index) {
-                if(index >= next_future_index) break;
-                if(result_ready[index]) continue;
-                auto& future = futures[index];
-                if (future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-                    result_ready[index] = true;
-                    results[index] = future.get();
-                    free_threads.store(free_threads + 1);
-                    continue;
-                }
-                break;
-            }
+    template <typename BaseSearch, bool SPLIT_OUTCOMES>
+    typename ThreadedSearch<BaseSearch, SPLIT_OUTCOMES>::Worker ThreadedSearch<BaseSearch, SPLIT_OUTCOMES>::createWorker() const {
+        Worker worker = [this]() {
+            if constexpr (has_shared_table<BaseSearch>::value) return Worker(this->getSharedTable());
+            else return Worker();
+        }();
+        // cancelling this search stops all workers
+        worker.setCancellation(this->getCancellation());
+        return worker;
+    }
 
-            if(std::all_of(result_ready.begin(), result_ready.end(), [](const bool value) { return value; }))
-                break;
+    template <typename BaseSearch, bool SPLIT_OUTCOMES>
+    typename ThreadedSearch<BaseSearch, SPLIT_OUTCOMES>::Result ThreadedSearch<BaseSearch, SPLIT_OUTCOMES>::expectiminimax(const State& parent, const uint32_t depth, const uint32_t deep_depth, const SearchLimits& limits) {
+        if (StateMachine::isFinished(parent) || !depth) {
+            return ExtendedSearch<BaseSearch>::expectiminimax(parent, depth, deep_depth);
+        }
+        if constexpr (has_new_search<BaseSearch>::value) this->newSearch();
+        TimeManager time_manager{*this->getCancellation(), limits};
+        return searchRoot(parent, depth, deep_depth);
+    }
 
-            // check timeout
-            auto now = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - start).count();
-            if (elapsed >= time_limit) {
-                std::cout << "Aborting search after execution time of " << elapsed <<" seconds surpassed the time limit. Waiting for result.\n";
-                BaseSearch::timeout.store(true);
-            }
-            std::this_thread::sleep_for(std::chrono::milliseconds(1000)); // Check periodically
+    template <typename BaseSearch, bool SPLIT_OUTCOMES>
+    typename ThreadedSearch<BaseSearch, SPLIT_OUTCOMES>::Result ThreadedSearch<BaseSearch, SPLIT_OUTCOMES>::searchRoot(const State& parent, const uint32_t depth, const uint32_t deep_depth) {
+        if (StateMachine::isFinished(parent) || !depth) {
+            return ExtendedSearch<BaseSearch>::expectiminimax(parent, depth, deep_depth);
         }
 
-        return results;
+        // the threads are kept for later searches
+        const std::size_t thread_count = std::max(free_threads.load(), 1u);
+        if(!pool || pool->getThreadCount() != thread_count) pool = std::make_unique<ThreadPool>(thread_count);
+        workers.clear();
+        for(std::size_t index = 0; index < thread_count; ++index) workers.push_back(createWorker());
+
+        const Result result = splitSearch(parent, depth, deep_depth, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity());
+
+        for(const auto& worker : workers) {
+            this->node_count += worker.node_count;
+            this->skipped_children += worker.skipped_children;
+            if constexpr (has_table_statistics<BaseSearch>::value) this->addTableStatistics(worker.getTableStatistics());
+        }
+        workers.clear();
+        return result;
     }
 
-    template <typename BaseSearch>
-    typename ThreadedSearch<BaseSearch>::Result ThreadedSearch<BaseSearch>::expectiminimaxSingleLayer(const State& parent, const std::vector<std::unique_ptr<State>>& children, const std::vector<Result>& results) {
-        Result best_result{};
-        const bool is_evaluation = StateMachine::isEvaluationPhase(parent.next_event);
-        if(is_evaluation) {
-            if (StateMachine::isPlayerTurn(parent)) {
-                best_result.score = std::numeric_limits<int>::min();
-                for (size_t i = 0; i < results.size(); ++i) {
-                    const Result& result = results[i];
-                    if (result.score > best_result.score) {
-                        best_result = result;
-                        best_result.follow_ups.push_front(children[i]->next_event);
-                    }
+    template <typename BaseSearch, bool SPLIT_OUTCOMES>
+    typename ThreadedSearch<BaseSearch, SPLIT_OUTCOMES>::Result ThreadedSearch<BaseSearch, SPLIT_OUTCOMES>::splitSearch(const State& parent, const uint32_t depth, const uint32_t deep_depth, double alpha, double beta) {
+        Worker& worker = getWorker();
+        // small subtrees are not worth the scheduling
+        if(StateMachine::isFinished(parent) || std::min(depth + deep_depth, StateMachine::getMaxDepth(parent)) < parameters::MIN_SPLIT_DEPTH) {
+            return worker.expectiminimax(parent, depth, deep_depth, alpha, beta);
+        }
+        // once cancelled, the base search ends the deep part right away, e.g. with the result of its last completed iteration
+        if(!depth && this->getCancellation()->isCancelled()) {
+            return worker.expectiminimax(parent, depth, deep_depth, alpha, beta);
+        }
+        // the base search knows the score of solved states of the deep part without searching
+        if constexpr (has_exact_score<Evaluator>::value) {
+            if(!depth && Evaluator::getExactScore(parent)) return worker.expectiminimax(parent, depth, deep_depth, alpha, beta);
+        }
+        ++worker.node_count;
+        // below the shallow depth only the score is computed, like the base search does
+        const bool is_shallow = depth > 0;
+        const uint32_t child_depth = is_shallow ? depth - 1 : 0;
+        const uint32_t child_deep_depth = is_shallow ? deep_depth : deep_depth - 1;
+        const uint32_t ordering_depth = is_shallow ? depth : deep_depth;
+
+        // the children are only read by other threads and outlive all tasks of this node
+        arena::Arena::Scope scope{arena::Arena::local()};
+        const auto children = StateMachine::getChildStates(parent, scope.getArena());
+        assert(!children.empty());
+        if(children.size() == 1) {
+            // skip single childs in depth computation
+            Result end_result = splitSearch(children.front(), depth, deep_depth, alpha, beta);
+            const auto& next_event = children.front().next_event;
+            if(is_shallow && next_event.action != engine::Action::Evaluating)
+                end_result.follow_ups.push_front(next_event);
+            return end_result;
+        }
+
+        Result end_result;
+        if(!StateMachine::isEvaluationPhase(parent.next_event)) {
+            if constexpr (SPLIT_OUTCOMES) {
+                if(std::min(depth + deep_depth, StateMachine::getMaxDepth(parent)) >= parameters::MIN_OUTCOME_SPLIT_DEPTH) {
+                    return splitOutcomes(children, child_depth, child_deep_depth, alpha, beta);
+                }
+            }
+            // random event happens, the outcomes are searched one after another since each one narrows the window of the next
+            double total_probability = 0.0;
+            if constexpr (Worker::CHANCE_PRUNING == ChancePruning::None) {
+                for( const auto& child : children ) {
+                    const Result result = splitSearch(child, child_depth, child_deep_depth, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity());
+                    if(isAborted(result.score)) return result;
+                    total_probability += child.probability;
+                    end_result.score += child.probability * result.score;
                 }
             } else {
-                best_result.score = std::numeric_limits<int>::max();
-                for (size_t i = 0; i < results.size(); ++i) {
-                    const Result& result = results[i];
-                    if (result.score < best_result.score) {
-                        best_result = result;
-                        best_result.follow_ups.push_front(children[i]->next_event);
+                ChanceWindow window{alpha, beta, Evaluator::MIN_SCORE, Evaluator::MAX_SCORE};
+                for( const auto& child : children ) window.addOutcome(child.probability);
+                for(std::size_t index = 0; index < children.size(); ++index) {
+                    const auto& child = children[index];
+                    const Result result = splitSearch(child, child_depth, child_deep_depth, window.getAlpha(index), window.getBeta(index));
+                    if(isAborted(result.score)) return result;
+                    if(const auto cut = window.setScore(index, result.score)) {
+                        end_result.score = *cut;
+                        return end_result;
                     }
+                    total_probability += child.probability;
+                    end_result.score += child.probability * result.score;
                 }
             }
-        } else {
-            // random event happens
-            double total_probability = 0.0;
-            for (size_t i = 0; i < results.size(); ++i) {
-                const Result& result = results[i];
-                const auto& child = children[i];
-                total_probability += child->probability;
-                best_result.score += child->probability * result.score;
-            }
             assert(std::abs(total_probability - 1.0) < parameters::EPSILON);
+            return end_result;
         }
 
-        return best_result;
-    }
+        const bool is_player_turn = StateMachine::isPlayerTurn(parent);
+        std::array<std::uint8_t, CAPACITY> order;
+        std::iota(order.begin(), order.begin() + children.size(), 0);
+        if constexpr (has_move_ordering<BaseSearch>::value) {
+            if constexpr (BaseSearch::MoveOrdering::ENABLED) {
+                std::array<std::uint32_t, CAPACITY> scores;
+                for(std::size_t index = 0; index < children.size(); ++index) {
+                    scores[index] = worker.move_ordering.getScore(parent, children[index].next_event, ordering_depth);
+                }
+                sortByScore(order, scores, children.size());
+            }
+        }
 
-    template <typename BaseSearch>
-    typename ThreadedSearch<BaseSearch>::Result ThreadedSearch<BaseSearch>::expectiminimax(const State& parent, const uint32_t depth, const uint32_t deep_depth, const double time_limit) {
-        if (StateMachine::isFinished(parent) || !depth) {
-            return ExtendedSearch<BaseSearch>::expectiminimax(parent, depth, deep_depth);
+        // state shared by all siblings of this node
+        struct SplitPoint{
+            std::mutex mutex;
+            double alpha;
+            double beta;
+            bool is_cut{false};
+            bool is_aborted{false};
+            std::array<Result, CAPACITY> results{};
+            std::array<bool, CAPACITY> is_searched{};
+        } split;
+        split.alpha = alpha;
+        split.beta = beta;
+
+        // must be called with the mutex of the split point locked
+        const auto addResult = [&split, is_player_turn](const std::size_t index, Result&& result) {
+            if(isAborted(result.score)) {
+                split.is_aborted = true;
+                return;
+            }
+            if(is_player_turn) {
+                if(result.score > split.beta) split.is_cut = true;
+                else split.alpha = std::max(split.alpha, result.score);
+            } else {
+                if(result.score < split.alpha) split.is_cut = true;
+                else split.beta = std::min(split.beta, result.score);
+            }
+            split.results[index] = std::move(result);
+            split.is_searched[index] = true;
+        };
+
+        // the eldest brother is searched alone
+        Result eldest = splitSearch(children[order[0]], child_depth, child_deep_depth, alpha, beta);
+        if(isAborted(eldest.score)) return eldest;
+        addResult(order[0], std::move(eldest));
+
+        if(!split.is_cut) {
+            const auto searchSibling = [this, &split, &children, &addResult, child_depth, child_deep_depth](const std::size_t index) {
+                double sibling_alpha, sibling_beta;
+                {
+                    std::lock_guard<std::mutex> lock(split.mutex);
+                    if(split.is_aborted) return;
+                    if(split.is_cut) {
+                        ++getWorker().skipped_children;
+                        return;
+                    }
+                    sibling_alpha = split.alpha;
+                    sibling_beta = split.beta;
+                }
+                Result result = splitSearch(children[index], child_depth, child_deep_depth, sibling_alpha, sibling_beta);
+                std::lock_guard<std::mutex> lock(split.mutex);
+                addResult(index, std::move(result));
+            };
+            ThreadPool::TaskGroup siblings{*pool};
+            // pushed in reverse, so this thread takes them in the order of the sequential search while thieves take the youngest
+            for(std::size_t position = children.size() - 1; position > 0; --position) siblings.spawn(searchSibling, order[position]);
+            siblings.wait();
+        }
+        if(split.is_aborted) {
+            end_result.score = ABORTED_SCORE;
+            return end_result;
         }
 
-        auto children = StateMachine::getChildStates(parent);
-        const auto results = expectiminimaxThreaded(children, depth, deep_depth, time_limit);
-        return expectiminimaxSingleLayer(parent, children, results);
+        // equal scores prefer the child that comes first in generation order, like the sequential search
+        Event best_event;
+        std::size_t best_index{children.size()};
+        end_result.score = is_player_turn ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+        for(std::size_t index = 0; index < children.size(); ++index) {
+            if(!split.is_searched[index]) continue;
+            const Result& result = split.results[index];
+            if(is_player_turn ? result.score > end_result.score : result.score < end_result.score) {
+                end_result = result;
+                best_event = children[index].next_event;
+                best_index = index;
+            }
+        }
+        if constexpr (has_move_ordering<BaseSearch>::value) {
+            if(split.is_cut) worker.move_ordering.addCutoff(parent, children[best_index].next_event, ordering_depth);
+        }
+        if(is_shallow) end_result.follow_ups.push_front(best_event);
+        return end_result;
+    }
+
+    template <typename BaseSearch, bool SPLIT_OUTCOMES>
+    typename ThreadedSearch<BaseSearch, SPLIT_OUTCOMES>::Result ThreadedSearch<BaseSearch, SPLIT_OUTCOMES>::splitOutcomes(const arena::Span<State>& children, const uint32_t depth, const uint32_t deep_depth, const double alpha, const double beta) {
+        // state shared by all outcomes of this node
+        struct SplitPoint{
+            SplitPoint(const double alpha, const double beta) : window(alpha, beta, Evaluator::MIN_SCORE, Evaluator::MAX_SCORE) {}
+            std::mutex mutex;
+            ChanceWindow window;
+            std::optional<double> cut;
+            bool is_aborted{false};
+            std::array<double, CAPACITY> scores{};
+        } split{alpha, beta};
+        for( const auto& child : children ) split.window.addOutcome(child.probability);
+
+        // outcomes that start later get the window that the finished ones left
+        const auto searchOutcome = [this, &split, &children, depth, deep_depth](const std::size_t index) {
+            double outcome_alpha = -std::numeric_limits<double>::infinity();
+            double outcome_beta = std::numeric_limits<double>::infinity();
+            {
+                std::lock_guard<std::mutex> lock(split.mutex);
+                if(split.is_aborted) return;
+                if constexpr (Worker::CHANCE_PRUNING != ChancePruning::None) {
+                    if(split.cut) {
+                        ++getWorker().skipped_children;
+                        return;
+                    }
+                    outcome_alpha = split.window.getAlpha(index);
+                    outcome_beta = split.window.getBeta(index);
+                }
+            }
+            const Result result = splitSearch(children[index], depth, deep_depth, outcome_alpha, outcome_beta);
+            std::lock_guard<std::mutex> lock(split.mutex);
+            if(isAborted(result.score)) {
+                split.is_aborted = true;
+                return;
+            }
+            split.scores[index] = result.score;
+            if constexpr (Worker::CHANCE_PRUNING != ChancePruning::None) {
+                // the window may have narrowed during the search, the result is still a valid bound of the outcome
+                if(!split.cut) split.cut = split.window.setScore(index, result.score);
+            }
+        };
+        ThreadPool::TaskGroup outcomes{*pool};
+        // pushed in reverse, so this thread takes them in the order of the sequential search while thieves take the last ones.
+        // Even the first outcome is a task, an exception must not leave this node while other tasks still use it
+        for(std::size_t index = children.size(); index-- > 0;) outcomes.spawn(searchOutcome, index);
+        outcomes.wait();
+
+        Result end_result;
+        if(split.is_aborted) {
+            end_result.score = ABORTED_SCORE;
+            return end_result;
+        }
+        if(split.cut) {
+            end_result.score = *split.cut;
+            return end_result;
+        }
+        // summed in the order of the sequential search, so rounding does not depend on the threads
+        double total_probability = 0.0;
+        for(std::size_t index = 0; index < children.size(); ++index) {
+            total_probability += children[index].probability;
+            end_result.score += children[index].probability * split.scores[index];
+        }
+        assert(std::abs(total_probability - 1.0) < parameters::EPSILON);
+        return end_result;
     }
 }
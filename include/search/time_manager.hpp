@@ -0,0 +1,48 @@
+#pragma once
+
+#include <mutex>
+#include <thread>
+#include <cstddef>
+#include <condition_variable>
+#include "parameters.hpp"
+#include "search/cancellation_token.hpp"
+
+namespace search{
+
+    /// @brief Limits of a single search
+    struct SearchLimits {
+        /// @param time_limit seconds until the search is cancelled, no iteration starts after a share of it
+        /// @param node_limit nodes until the search is cancelled, zero means no limit
+        SearchLimits(const double time_limit = parameters::TIME_LIMIT, const std::size_t node_limit = 0)
+            : time_limit(time_limit), soft_time_limit(time_limit * parameters::SOFT_TIME_LIMIT_SHARE), node_limit(node_limit) {}
+
+        // hard deadline in seconds, the search is cancelled
+        double time_limit;
+        // soft deadline in seconds, iterative deepening at the root does not start another iteration
+        double soft_time_limit;
+        std::size_t node_limit;
+    };
+
+    /// @brief Applies the limits to a search while it lives and allows the search to run again when destroyed.
+    /// The hard deadline cancels the search from a thread of its own, the node limit is checked whenever the search polls its token.
+    class TimeManager {
+    public:
+        /// @param token token of the search to limit
+        /// @param limits limits of the search, counted from now
+        TimeManager(CancellationToken& token, const SearchLimits& limits);
+        ~TimeManager();
+        TimeManager(const TimeManager&) = delete;
+        TimeManager& operator=(const TimeManager&) = delete;
+
+        /// @brief Cancels the search before the time limit, e.g. once the result is already known
+        void stop();
+
+    private:
+        CancellationToken& token;
+        std::mutex mutex;
+        std::condition_variable wake_up;
+        bool finished{false};
+        bool stopped{false};
+        std::thread thread;
+    };
+}
@@ -1,17 +1,19 @@
 #pragma once
 
-#include <deque>
 #include <memory>
 #include <cassert>
-#include <stdexcept>
 #include <limits>
+#include <atomic>
 #include "parameters.hpp"
-#include <unordered_map>
-#include <list>
-#include <mutex>
+#include "search/search_traits.hpp"
+#include "search/cancellation_token.hpp"
+#include "search/move_ordering.hpp"
+#include "search/chance_pruning.hpp"
+#include "search/principal_variation.hpp"
+#include "search/transposition_table.hpp"
 
 namespace search{
-    template <typename StateMachineType, typename EvaluatorType>
+    template <typename StateMachineType, typename EvaluatorType, typename MoveOrderingType = NoMoveOrdering, ChancePruning CHANCE_PRUNING_MODE = ChancePruning::Star1, bool PRINCIPAL_VARIATION_SEARCH = false>
     class TranspositionSearch {
     public:
         using StateMachine = StateMachineType;
@@ -19,9 +21,31 @@ namespace search{
         using State = typename StateMachine::State;
         using Event = typename StateMachine::Event;
         using Result = double;
+        using MoveOrdering = MoveOrderingType;
+        using ChanceWindow = search::ChanceWindow<StateMachine::MoveList::CAPACITY>;
+        static constexpr ChancePruning CHANCE_PRUNING{CHANCE_PRUNING_MODE};
 
-        // set the timeout to stop evaluation immediately
-        static std::atomic<bool> timeout;
+        // number of visited nodes
+        std::size_t node_count{0};
+
+        // number of children that were never created due to pruning
+        std::size_t skipped_children{0};
+
+        // learns which decisions cause cutoffs
+        MoveOrdering move_ordering;
+
+        explicit TranspositionSearch(const std::size_t table_size_mb = parameters::TRANSPOSITION_TABLE_SIZE_MB)
+            : transposition_table(std::make_shared<TranspositionTable>(table_size_mb)) {}
+
+        /// @brief Creates a search that uses the table of another search, e.g. in another thread
+        /// @param table shared transposition table
+        explicit TranspositionSearch(std::shared_ptr<TranspositionTable> table) : transposition_table(std::move(table)) {}
+
+        /// @brief Token that stops this search, threads that work on the same search share it
+        std::shared_ptr<CancellationToken> getCancellation() const { return cancellation; }
+
+        /// @brief Lets another token stop this search, e.g. the one of the search this search works for
+        void setCancellation(std::shared_ptr<CancellationToken> token) { cancellation = std::move(token); }
 
         /// @brief Performs the minimax algorithm only to find the score of the parent
         /// @param parent state to evaluate
@@ -31,85 +55,255 @@ namespace search{
         /// @return best score that the parent gets
         double expectiminimax(const State& parent, const uint32_t depth, double alpha = -std::numeric_limits<double>::infinity(), double beta = std::numeric_limits<double>::infinity());
 
-        void update_cache(const State& state, const double result, const uint32_t depth);
+        /// @brief Bounds an outcome of a random event with its stored result or by searching only its first decision (Star2)
+        /// @param outcome child of a chance node
+        /// @param depth depth the outcome would be searched with
+        /// @param window window of the chance node that receives the bounds
+        /// @param index index of the outcome in the window
+        void probe(const State& outcome, const uint32_t depth, ChanceWindow& window, const std::size_t index);
+
+        void update_cache(const State& state, const double result, const uint32_t depth, const TranspositionTable::Bound bound = TranspositionTable::Bound::Exact,
+                          const std::uint8_t best_move = TranspositionTable::NO_MOVE);
+
+        /// @brief Ages the stored results, call before every iterative deepening pass
+        void newSearch();
+
+        /// @brief Table that other searches may share
+        std::shared_ptr<TranspositionTable> getSharedTable() const { return transposition_table; }
+
+        /// @brief Usage of the transposition table by this search
+        TranspositionTable::Statistics getTableStatistics() const;
+
+        /// @brief Adds the usage of a search that shared the table
+        void addTableStatistics(const TranspositionTable::Statistics& other) { table_statistics += other; }
 
     private:
-        size_t max_cache_size{5000000};
-        std::unordered_map<State, std::tuple<double, uint32_t>> transposition_table;
-        std::mutex table_mutex;
+        std::shared_ptr<TranspositionTable> transposition_table;
+        std::shared_ptr<CancellationToken> cancellation{std::make_shared<CancellationToken>()};
+        // nodes that were already reported to the token
+        std::size_t polled_nodes{0};
+
+        /// @brief Reports the nodes since the last poll to the token
+        /// @return Whether the search is cancelled
+        bool poll() {
+            const bool is_cancelled = cancellation->poll(node_count - polled_nodes);
+            polled_nodes = node_count;
+            return is_cancelled;
+        }
+        TranspositionTable::Statistics table_statistics;
     };
 
-    template <typename StateMachineType, typename EvaluatorType>
-    std::atomic<bool> TranspositionSearch<StateMachineType, EvaluatorType>::timeout{false};
+    template <typename StateMachineType, typename EvaluatorType, typename MoveOrderingType, ChancePruning CHANCE_PRUNING_MODE, bool PRINCIPAL_VARIATION_SEARCH>
+    void TranspositionSearch<StateMachineType, EvaluatorType, MoveOrderingType, CHANCE_PRUNING_MODE, PRINCIPAL_VARIATION_SEARCH>::update_cache(const State& state, const double result, const uint32_t depth, const TranspositionTable::Bound bound, const std::uint8_t best_move) {
+        if(transposition_table->store(state.key, result, depth, bound, best_move)) ++table_statistics.overwrites;
+    }
+
+    template <typename StateMachineType, typename EvaluatorType, typename MoveOrderingType, ChancePruning CHANCE_PRUNING_MODE, bool PRINCIPAL_VARIATION_SEARCH>
+    void TranspositionSearch<StateMachineType, EvaluatorType, MoveOrderingType, CHANCE_PRUNING_MODE, PRINCIPAL_VARIATION_SEARCH>::newSearch() {
+        transposition_table->newSearch();
+    }
 
-    template <typename StateMachineType, typename EvaluatorType>
-    void TranspositionSearch<StateMachineType, EvaluatorType>::update_cache(const State& state, const double result, const uint32_t depth) {
-        std::lock_guard<std::mutex> lock(table_mutex);
-        transposition_table[state] = {result, depth};
+    template <typename StateMachineType, typename EvaluatorType, typename MoveOrderingType, ChancePruning CHANCE_PRUNING_MODE, bool PRINCIPAL_VARIATION_SEARCH>
+    TranspositionTable::Statistics TranspositionSearch<StateMachineType, EvaluatorType, MoveOrderingType, CHANCE_PRUNING_MODE, PRINCIPAL_VARIATION_SEARCH>::getTableStatistics() const {
+        auto statistics = table_statistics;
+        statistics.fill = transposition_table->getFill();
+        return statistics;
     }
 
-    template <typename StateMachineType, typename EvaluatorType>
-    double TranspositionSearch<StateMachineType, EvaluatorType>::expectiminimax(const State& parent, const uint32_t depth, double alpha, double beta) {
-        if(timeout) throw std::runtime_error("timeout");
+    template <typename StateMachineType, typename EvaluatorType, typename MoveOrderingType, ChancePruning CHANCE_PRUNING_MODE, bool PRINCIPAL_VARIATION_SEARCH>
+    double TranspositionSearch<StateMachineType, EvaluatorType, MoveOrderingType, CHANCE_PRUNING_MODE, PRINCIPAL_VARIATION_SEARCH>::expectiminimax(const State& parent, const uint32_t depth, double alpha, double beta) {
+        ++node_count;
+        // the token is only polled every few nodes, an aborted search unwinds with a sentinel instead of a score
+        if(node_count % parameters::CANCELLATION_CHECK_INTERVAL == 0 && poll()) return ABORTED_SCORE;
 
+        // solved states are terminal nodes as well, even below the depth
+        if constexpr (has_exact_score<Evaluator>::value) {
+            if(const auto score = Evaluator::getExactScore(parent)) return *score;
+        }
         // terminal nodes
         if(StateMachine::isFinished(parent) || !depth) {
             return Evaluator::getScore(parent);
         }
 
-        {
-            std::lock_guard<std::mutex> lock(table_mutex);
-            auto it = transposition_table.find(parent);
-            if (it != transposition_table.end() && std::get<1>(it->second) >= depth) {
-                return std::get<0>(it->second);
+        // even results that are too shallow know which child to try first
+        std::uint8_t best_move{TranspositionTable::NO_MOVE};
+        const auto entry = transposition_table->probe(parent.key);
+        if (entry && entry->depth >= depth) {
+            ++table_statistics.hits;
+            // bounds narrow the window or cut if they lie outside of it
+            switch (entry->bound) {
+                case TranspositionTable::Bound::Exact:
+                    return entry->score;
+                case TranspositionTable::Bound::Lower:
+                    if (entry->score > beta) return entry->score;
+                    alpha = std::max(alpha, entry->score);
+                    break;
+                case TranspositionTable::Bound::Upper:
+                    if (entry->score < alpha) return entry->score;
+                    beta = std::min(beta, entry->score);
+                    break;
             }
+        } else {
+            ++table_statistics.misses;
         }
-        // get children:
-        auto children = StateMachine::getChildStates(parent);
-        assert(!children.empty());
+        if constexpr (MoveOrdering::TABLE_MOVE) {
+            if (entry) best_move = entry->best_move;
+        }
+        // get children lazily:
+        typename StateMachine::ChildGenerator children{parent};
+        assert(children.hasNext());
         if(children.size() == 1) {
             // skip single childs in depth computation
-            return expectiminimax(*children.front(), depth, alpha, beta);
+            return expectiminimax(children.next(), depth, alpha, beta);
         }
         const bool is_evaluation = StateMachine::isEvaluationPhase(parent.next_event);
 
         double end_result;
+        // a pruned node only knows a bound of its score
+        TranspositionTable::Bound bound{TranspositionTable::Bound::Exact};
+        const double window_alpha = alpha;
+        const double window_beta = beta;
         if(is_evaluation) {
+            if constexpr (MoveOrdering::ENABLED) {
+                children.sort([this, &parent, depth](const auto& move) { return move_ordering.getScore(parent, move.event, depth); });
+            }
+            // the best move of an earlier search beats every heuristic
+            if constexpr (MoveOrdering::TABLE_MOVE) {
+                if (best_move != TranspositionTable::NO_MOVE) children.prioritize(best_move);
+            }
             const bool is_player_turn = StateMachine::isPlayerTurn(parent);
             end_result = is_player_turn ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
 
-            for( auto& child : children ) {
-                const auto result = expectiminimax(*child, depth-1, alpha, beta);
+            bool is_first{true};
+            while(children.hasNext()) {
+                const auto child = children.next();
+                double result;
+                if constexpr (PRINCIPAL_VARIATION_SEARCH) {
+                    const auto searchChild = [this, &child, depth](const double child_alpha, const double child_beta) { return expectiminimax(child, depth-1, child_alpha, child_beta); };
+                    result = is_first ? searchChild(alpha, beta) : searchWithNullWindow(searchChild, is_player_turn, alpha, beta);
+                    is_first = false;
+                } else {
+                    result = expectiminimax(child, depth-1, alpha, beta);
+                }
+                if(isAborted(result)) return result;
                 if(is_player_turn) {
                     if (result > end_result) {
                         end_result = result;
+                        if constexpr (MoveOrdering::TABLE_MOVE) best_move = static_cast<std::uint8_t>(children.getMoveIndex());
                     }
                     // alpha-beta pruning
-                    if (end_result > beta) break;
+                    if (end_result > beta) {
+                        skipped_children += children.remaining();
+                        if constexpr (MoveOrdering::ENABLED) move_ordering.addCutoff(parent, children.getMove().event, depth);
+                        break;
+                    }
                     alpha = std::max(alpha, end_result);
                 } else {
                     if (result < end_result) {
                         end_result = result;
+                        if constexpr (MoveOrdering::TABLE_MOVE) best_move = static_cast<std::uint8_t>(children.getMoveIndex());
                     }
                     // alpha-beta pruning
-                    if (end_result < alpha) break;
+                    if (end_result < alpha) {
+                        skipped_children += children.remaining();
+                        if constexpr (MoveOrdering::ENABLED) move_ordering.addCutoff(parent, children.getMove().event, depth);
+                        break;
+                    }
                     beta = std::min(beta, end_result);
                 }
             }
+            if(end_result > window_beta) bound = TranspositionTable::Bound::Lower;
+            else if(end_result < window_alpha) bound = TranspositionTable::Bound::Upper;
+            // after failing low every child was bad, the best one is just noise
+            if(bound == TranspositionTable::Bound::Upper) best_move = TranspositionTable::NO_MOVE;
         } else {
-            // random event happens
+            // random event happens, there is no move to remember
+            best_move = TranspositionTable::NO_MOVE;
             end_result = 0.0;
             double total_probability = 0.0;
-            for( const auto& child : children ) {
-                // accumulate results
-                const double result = expectiminimax(*child, depth-1, alpha, beta);
-                total_probability += child->probability;
-                end_result += child->probability * result;
+            if constexpr (CHANCE_PRUNING == ChancePruning::None) {
+                while(children.hasNext()) {
+                    // accumulate results
+                    const auto child = children.next();
+                    // the window bounds the weighted sum, not single outcomes, so outcomes are searched without one
+                    const double result = expectiminimax(child, depth-1, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity());
+                    if(isAborted(result)) return result;
+                    total_probability += child.probability;
+                    end_result += child.probability * result;
+                }
+                assert(std::abs(total_probability - 1.0) < parameters::EPSILON);
+            } else {
+                ChanceWindow window{alpha, beta, Evaluator::MIN_SCORE, Evaluator::MAX_SCORE};
+                for(const auto& move : children.getMoves()) window.addOutcome(move.probability);
+                std::optional<double> cut;
+                if constexpr (CHANCE_PRUNING == ChancePruning::Star2) {
+                    typename StateMachine::ChildGenerator outcomes{parent};
+                    while(!cut && outcomes.hasNext()) {
+                        const auto outcome = outcomes.next();
+                        probe(outcome, depth-1, window, outcomes.getMoveIndex());
+                        cut = window.getCut();
+                    }
+                    if(cut) skipped_children += children.size();
+                }
+                while(!cut && children.hasNext()) {
+                    // accumulate results
+                    const auto child = children.next();
+                    const std::size_t index = children.getMoveIndex();
+                    // the window of an outcome is as wide as the other outcomes allow (Star1)
+                    const double result = expectiminimax(child, depth-1, window.getAlpha(index), window.getBeta(index));
+                    if(isAborted(result)) return result;
+                    cut = window.setScore(index, result);
+                    if(cut) skipped_children += children.remaining();
+                    total_probability += child.probability;
+                    end_result += child.probability * result;
+                }
+                if(cut) {
+                    end_result = *cut;
+                    bound = end_result > window_beta ? TranspositionTable::Bound::Lower : TranspositionTable::Bound::Upper;
+                } else {
+                    assert(std::abs(total_probability - 1.0) < parameters::EPSILON);
+                }
             }
-            assert(std::abs(total_probability - 1.0) < parameters::EPSILON);
         }
 
-        update_cache(parent, end_result, depth);
+        update_cache(parent, end_result, depth, bound, best_move);
         return end_result;
     }
+
+    template <typename StateMachineType, typename EvaluatorType, typename MoveOrderingType, ChancePruning CHANCE_PRUNING_MODE, bool PRINCIPAL_VARIATION_SEARCH>
+    void TranspositionSearch<StateMachineType, EvaluatorType, MoveOrderingType, CHANCE_PRUNING_MODE, PRINCIPAL_VARIATION_SEARCH>::probe(const State& outcome, const uint32_t depth, ChanceWindow& window, const std::size_t index) {
+        if(StateMachine::isFinished(outcome) || !depth) return;
+        // a stored result bounds the outcome without searching anything
+        std::uint8_t best_move{TranspositionTable::NO_MOVE};
+        if(const auto entry = transposition_table->probe(outcome.key)) {
+            if(entry->depth >= depth) {
+                if(entry->bound != TranspositionTable::Bound::Upper) window.setLower(index, entry->score);
+                if(entry->bound != TranspositionTable::Bound::Lower) window.setUpper(index, entry->score);
+                if(entry->bound == TranspositionTable::Bound::Exact) return;
+            }
+            if constexpr (MoveOrdering::TABLE_MOVE) best_move = entry->best_move;
+        }
+        // only decisions can be probed
+        if(!StateMachine::isEvaluationPhase(outcome.next_event)) return;
+        typename StateMachine::ChildGenerator children{outcome};
+        if(children.size() == 1) return;
+        // probe the decision the full search would try first, its result is stored for that search
+        if constexpr (MoveOrdering::ENABLED) {
+            children.sort([this, &outcome, depth](const auto& move) { return move_ordering.getScore(outcome, move.event, depth); });
+        }
+        if constexpr (MoveOrdering::TABLE_MOVE) {
+            if (best_move != TranspositionTable::NO_MOVE) children.prioritize(best_move);
+        }
+        if(StateMachine::isPlayerTurn(outcome)) {
+            const double target = window.getBeta(index);
+            if(!window.isReachable(target)) return;
+            const double result = expectiminimax(children.next(), depth-1, target, target);
+            if(result >= target) window.setLower(index, result);
+        } else {
+            const double target = window.getAlpha(index);
+            if(!window.isReachable(target)) return;
+            const double result = expectiminimax(children.next(), depth-1, target, target);
+            if(result <= target) window.setUpper(index, result);
+        }
+    }
 }
\ No newline at end of file
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <algorithm>
+#include <initializer_list>
+
+namespace search{
+
+    /// @brief Fixed-size hash table of search results that never grows after construction.
+    /// Each bucket fills one cache line and holds a depth-preferred and an always-replace slot.
+    /// The table is lock-free and may be shared by all threads of a search: every slot stores its key xor-ed with its data,
+    /// so an entry that was torn by concurrent writes fails verification and is treated as a miss.
+    class TranspositionTable {
+    public:
+        // relation of a stored score to the real score of the position
+        enum class Bound : std::uint8_t {
+            Exact, // the score was inside the search window
+            Lower, // the search failed high, the real score is at least as high
+            Upper  // the search failed low, the real score is at most as high
+        };
+
+        // marks entries without a best move
+        static constexpr std::uint8_t NO_MOVE{0xFF};
+
+        struct Entry{
+            std::uint64_t key{0};
+            double score{0.0};
+            std::uint32_t depth{0};
+            std::uint8_t generation{0};
+            Bound bound{Bound::Exact};
+            std::uint8_t best_move{NO_MOVE}; // index of the best child in generation order
+        };
+
+        struct Statistics{
+            std::size_t hits{0};
+            std::size_t misses{0};
+            std::size_t overwrites{0}; // stores that evicted a different position
+            double fill{0.0}; // share of used slots
+
+            Statistics& operator+=(const Statistics& other) {
+                hits += other.hits;
+                misses += other.misses;
+                overwrites += other.overwrites;
+                fill = std::max(fill, other.fill);
+                return *this;
+            }
+        };
+
+        /// @param size_mb memory of the table in megabytes, rounded down to a power of two number of buckets
+        explicit TranspositionTable(const std::size_t size_mb) {
+            const std::size_t max_buckets = std::max<std::size_t>(size_mb * 1024 * 1024 / sizeof(Bucket), 1);
+            std::size_t bucket_count = 1;
+            while(bucket_count * 2 <= max_buckets) bucket_count *= 2;
+            // calloc maps zeroed pages lazily, so untouched parts of a large table cost nothing.
+            // lock-free atomic integers are plain integers in memory, an all zero bucket holds two empty slots
+            memory.reset(std::calloc(bucket_count * sizeof(Bucket) + alignof(Bucket), 1));
+            if(!memory) throw std::bad_alloc{};
+            const auto address = reinterpret_cast<std::uintptr_t>(memory.get());
+            buckets = reinterpret_cast<Bucket*>((address + alignof(Bucket) - 1) & ~(alignof(Bucket) - 1));
+            mask = bucket_count - 1;
+        }
+
+        /// @brief Looks up a position
+        /// @param key zobrist key of the position
+        /// @return stored entry of any depth
+        std::optional<Entry> probe(const std::uint64_t key) {
+            Bucket& bucket = buckets[key & mask];
+            const std::uint8_t current_generation = generation.load(std::memory_order_relaxed);
+            std::optional<Entry> result;
+            for(Slot* slot : {&bucket.depth_preferred, &bucket.always_replace}) {
+                auto entry = slot->load();
+                if(!entry || entry->key != key) continue;
+                // keep entries that are still useful from aging out
+                if(entry->generation != current_generation) {
+                    entry->generation = current_generation;
+                    slot->store(*entry);
+                }
+                if(!result || entry->depth > result->depth) result = entry;
+            }
+            return result;
+        }
+
+        /// @brief Looks up a position
+        /// @param key zobrist key of the position
+        /// @param depth minimal depth the stored result must have been searched with
+        /// @return stored entry if it is deep enough
+        std::optional<Entry> probe(const std::uint64_t key, const std::uint32_t depth) {
+            const auto entry = probe(key);
+            if(entry && entry->depth >= depth) return entry;
+            return std::nullopt;
+        }
+
+        /// @brief Stores a search result. Deeper results and results of the current search are kept in the depth-preferred slot,
+        /// everything else goes to the always-replace slot.
+        /// @return True if the result evicted a different position
+        bool store(const std::uint64_t key, const double score, const std::uint32_t depth, const Bound bound = Bound::Exact, const std::uint8_t best_move = NO_MOVE) {
+            Bucket& bucket = buckets[key & mask];
+            Entry entry{key, score, depth, generation.load(std::memory_order_relaxed), bound, best_move};
+            const auto preferred = bucket.depth_preferred.load();
+            // a result without a best move keeps the one that is known
+            if(best_move == NO_MOVE && preferred && preferred->key == key) entry.best_move = preferred->best_move;
+            if(!preferred || preferred->key == key || preferred->generation != entry.generation || depth >= preferred->depth) {
+                bucket.depth_preferred.store(entry);
+                // demote the old result instead of losing it
+                if(preferred && preferred->key != key) return replace(bucket.always_replace, *preferred);
+                return false;
+            }
+            return replace(bucket.always_replace, entry);
+        }
+
+        /// @brief Starts a new search, entries of previous searches may be replaced by shallower ones
+        void newSearch() { generation.fetch_add(1, std::memory_order_relaxed); }
+
+        /// @brief Estimates the share of used slots from the first buckets
+        double getFill() const {
+            const std::size_t sample = std::min<std::size_t>(getBucketCount(), 1024);
+            std::size_t used_slots{0};
+            for(std::size_t index = 0; index < sample; ++index) {
+                used_slots += buckets[index].depth_preferred.isUsed() + buckets[index].always_replace.isUsed();
+            }
+            return used_slots / (2.0 * sample);
+        }
+
+        std::size_t getBucketCount() const { return mask + 1; }
+
+    private:
+        class Slot {
+        public:
+            std::optional<Entry> load() const {
+                const std::uint64_t score_bits = score.load(std::memory_order_relaxed);
+                const std::uint64_t meta_bits = meta.load(std::memory_order_relaxed);
+                if(!(meta_bits & USED)) return std::nullopt;
+                Entry entry;
+                entry.key = check.load(std::memory_order_relaxed) ^ score_bits ^ meta_bits;
+                std::memcpy(&entry.score, &score_bits, sizeof(double));
+                entry.depth = static_cast<std::uint32_t>(meta_bits);
+                entry.generation = static_cast<std::uint8_t>(meta_bits >> 32);
+                entry.bound = static_cast<Bound>((meta_bits >> BOUND_SHIFT) & 3);
+                // moves are stored shifted by one so that zeroed memory has no move
+                entry.best_move = static_cast<std::uint8_t>(((meta_bits >> MOVE_SHIFT) & 31) - 1);
+                return entry;
+            }
+
+            void store(const Entry& entry) {
+                std::uint64_t score_bits;
+                std::memcpy(&score_bits, &entry.score, sizeof(double));
+                const std::uint64_t meta_bits = USED | static_cast<std::uint64_t>(entry.bound) << BOUND_SHIFT
+                                              | static_cast<std::uint64_t>(static_cast<std::uint8_t>(entry.best_move + 1) & 31) << MOVE_SHIFT
+                                              | static_cast<std::uint64_t>(entry.generation) << 32 | entry.depth;
+                // a reader that sees a mix of two stores computes a wrong key
+                check.store(entry.key ^ score_bits ^ meta_bits, std::memory_order_relaxed);
+                score.store(score_bits, std::memory_order_relaxed);
+                meta.store(meta_bits, std::memory_order_relaxed);
+            }
+
+            bool isUsed() const { return meta.load(std::memory_order_relaxed) & USED; }
+
+        private:
+            static constexpr std::uint64_t USED{std::uint64_t{1} << 40};
+            static constexpr unsigned int BOUND_SHIFT{41};
+            static constexpr unsigned int MOVE_SHIFT{43};
+
+            std::atomic<std::uint64_t> check;
+            std::atomic<std::uint64_t> score;
+            std::atomic<std::uint64_t> meta;
+        };
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+
+        struct alignas(64) Bucket{
+            Slot depth_preferred;
+            Slot always_replace;
+        };
+
+        static bool replace(Slot& slot, const Entry& entry) {
+            const auto old_entry = slot.load();
+            slot.store(entry);
+            return old_entry && old_entry->key != entry.key;
+        }
+
+        struct FreeDeleter{
+            void operator()(void* pointer) const { std::free(pointer); }
+        };
+
+        std::unique_ptr<void, FreeDeleter> memory;
+        Bucket* buckets{nullptr};
+        std::size_t mask{0};
+        std::atomic<std::uint8_t> generation{0};
+    };
+}
@@ -1,12 +1,27 @@
 #include "engine/agents/automatic_intelligent_agent.hpp"
+#include <chrono>
 
 namespace engine{
 
     State AutomaticIntelligentAgent::getSuccessor(State state, std::vector<std::unique_ptr<State>> children) {
+        if(StateMachine::isForcedMove(state)) {
+            // no need to search when there is only one option
+            assert(children.size() == 1);
+            if(!last_result.follow_ups.empty() && last_result.follow_ups.front() == children.front()->next_event) {
+                last_result.follow_ups.pop_front();
+            } else {
+                last_result = {};
+            }
+            return std::move(*children.front());
+        }
         if(logging) std::cout << "Evaluating options... (can take a while on the first rounds)\n";
         Search::Result best_choice;
         if(last_result.follow_ups.empty() || last_result.follow_ups.front().is_player_turn != state.next_event.is_player_turn) {
-            best_choice = getBestChoice(state, logging);
+            const auto start = std::chrono::steady_clock::now();
+            best_choice = getBestChoice(state, logging, limits);
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            ++search_count;
+            search_seconds += elapsed.count();
         } else {
             best_choice = last_result;
         }
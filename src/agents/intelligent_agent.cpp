@@ -2,13 +2,13 @@
 
 namespace engine{
 
-    IntelligentAgent::Search::Result IntelligentAgent::getBestChoice(const State& state, const bool logging) const{
+    IntelligentAgent::Search::Result IntelligentAgent::getBestChoice(const State& state, const bool logging, const search::SearchLimits& limits) const{
 
         const unsigned int max_depth = parameters::MAX_SHALLOW_DEPTH;
         const unsigned int max_deep_depth = std::max(max_depth + 1, StateMachine::getMaxDepth(state));
         Search solver;
 
         // evaluate best choice
-        return solver.expectiminimax(state, max_depth, max_deep_depth, time_limit);
+        return solver.expectiminimax(state, max_depth, max_deep_depth, limits);
     }
 }
\ No newline at end of file
@@ -3,8 +3,8 @@
 #include <limits>
 
 namespace{   
-    void displayItems(const std::vector<engine::Item>& items) {
-        for (const auto& item : items) {
+    void displayItems(const engine::ItemSet& items) {
+        for (const auto item : items.toVector()) {
             std::cout << engine::toString(item) << " ";
         }
         std::cout << "\n";
@@ -6,11 +6,22 @@ namespace engine{
         const auto rounds_left = state.shotgun.getRemainingRounds();
         if(rounds_left) std::cout << "Probability for blank round: " << StateMachine::getProbabilityOfBlankRound(state, children.front()->inverter_used) << ".\n";
 
+        if(StateMachine::isForcedMove(state)) {
+            // no need to search when there is only one option
+            auto choice = InteractiveAgent::getSuccessor(std::move(state), std::move(children));
+            if(!last_result.follow_ups.empty() && last_result.follow_ups.front() == choice.next_event) {
+                last_result.follow_ups.pop_front();
+            } else {
+                reset();
+            }
+            return choice;
+        }
+
         Search::Result best_choice;
         if(last_result.follow_ups.empty() || last_result.follow_ups.front().is_player_turn != state.next_event.is_player_turn) {
             std::cout << "Evaluating options... (can take a while on the first rounds)\n";
             // evaluate best choice
-            best_choice = IntelligentAgent::getBestChoice(state, true);
+            best_choice = IntelligentAgent::getBestChoice(state, true, limits);
             std::cout << search::toString<Search::Result, Evaluator>(best_choice);
         } else {
             std::cout << "Using result from previous search:\n";
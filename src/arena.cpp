@@ -0,0 +1,23 @@
+#include "arena.hpp"
+#include <algorithm>
+
+namespace arena{
+
+    Arena& Arena::local() {
+        thread_local Arena arena;
+        return arena;
+    }
+
+    void Arena::nextBlock(const std::size_t min_bytes) {
+        const std::size_t next_block = blocks.empty() ? 0 : current_block + 1;
+        const std::size_t size = std::max(block_size, min_bytes);
+        if(next_block == blocks.size()) {
+            blocks.push_back({std::make_unique<std::byte[]>(size), size});
+        } else if(blocks[next_block].size < min_bytes) {
+            // blocks after the current one are unused and can be replaced
+            blocks[next_block] = {std::make_unique<std::byte[]>(size), size};
+        }
+        current_block = next_block;
+        offset = 0;
+    }
+}
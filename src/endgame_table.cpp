@@ -0,0 +1,74 @@
+#include "engine/endgame_table.hpp"
+#include "engine/state_machine.hpp"
+#include "engine/evaluator.hpp"
+#include <cmath>
+#include <limits>
+#include <cassert>
+#include <algorithm>
+
+namespace engine{
+
+    const EndgameTable EndgameTable::table{};
+
+    EndgameTable::EndgameTable() : scores(SIZE, std::numeric_limits<double>::quiet_NaN()) {
+        // every shot uses up a round, so states with fewer rounds are solved first
+        for(unsigned int rounds = 1; rounds <= game_parameters::MAX_SHELLS; ++rounds) {
+            for(unsigned int live_rounds = 0; live_rounds <= rounds; ++live_rounds) {
+                for(unsigned int player_lives = 1; player_lives <= game_parameters::MAX_LIVES; ++player_lives) {
+                    for(unsigned int dealer_lives = 1; dealer_lives <= game_parameters::MAX_LIVES; ++dealer_lives) {
+                        for(const bool is_player_turn : {false, true}) {
+                            for(const HandcuffType handcuffs : {HandcuffType::None, HandcuffType::Broken, HandcuffType::Intact}) {
+                                for(const bool sawed_off : {false, true}) {
+                                    State state{};
+                                    state.max_lives = game_parameters::MAX_LIVES;
+                                    state.player.lives = player_lives;
+                                    state.dealer.lives = dealer_lives;
+                                    state.shotgun.load(live_rounds, rounds - live_rounds);
+                                    if(sawed_off) state.shotgun.sawOff();
+                                    if(handcuffs != HandcuffType::None) state.handcuffs.add();
+                                    if(handcuffs == HandcuffType::Broken) state.handcuffs.decay();
+                                    state.next_event.is_player_turn = is_player_turn;
+                                    state.refreshKey();
+                                    assert(isCovered(state));
+                                    scores[getIndex(state)] = solve(state);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    double EndgameTable::solve(const State& state) const {
+        StateMachine::ChildGenerator children{state};
+        assert(children.hasNext());
+        if(!StateMachine::isEvaluationPhase(state.next_event)) {
+            // random event happens
+            double score{0.0};
+            while(children.hasNext()) {
+                const State child = children.next();
+                score += child.probability * getScore(child);
+            }
+            return score;
+        }
+        // the same choices as in the search, the dealer minimizes the score of the player
+        const bool is_player_turn = StateMachine::isPlayerTurn(state);
+        double score = is_player_turn ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+        while(children.hasNext()) {
+            const double result = getScore(children.next());
+            score = is_player_turn ? std::max(score, result) : std::min(score, result);
+        }
+        return score;
+    }
+
+    double EndgameTable::getScore(const State& state) const {
+        if(StateMachine::isFinished(state)) return Evaluator::getScore(state);
+        if(isCovered(state)) {
+            const double score = scores[getIndex(state)];
+            assert(!std::isnan(score));
+            return score;
+        }
+        return solve(state);
+    }
+}
@@ -16,13 +16,13 @@ namespace engine{
         assert(state.dealer.items.size() <= game_parameters::MAX_SLOTS);
         const int empty_slots = std::max(state.dealer.items.size(), MAX_SCORING_EMPTY_SLOTS) - std::max(state.player.items.size(), MAX_SCORING_EMPTY_SLOTS);
         player_advantage += static_cast<double>(empty_slots) * SCORES[0];
-        for(const auto item : state.player.items) {
-            assert(static_cast<unsigned>(item) < SCORES.size());
-            player_advantage += SCORES[static_cast<size_t>(item)];
-        }
-        for(const auto item : state.dealer.items) {
-            assert(static_cast<unsigned>(item) < SCORES.size());
-            player_advantage -= SCORES[static_cast<size_t>(item)];
+        // dot product of the item count differences with the item scores
+        const uint64_t player_counts = state.player.items.getCounts();
+        const uint64_t dealer_counts = state.dealer.items.getCounts();
+        for(std::size_t item = 1; item < SCORES.size(); ++item) {
+            const unsigned int shift = ItemSet::BITS_PER_ITEM * (item - 1);
+            const int count_difference = static_cast<int>((player_counts >> shift) & ItemSet::COUNTER_MASK) - static_cast<int>((dealer_counts >> shift) & ItemSet::COUNTER_MASK);
+            player_advantage += count_difference * SCORES[item];
         }
         return player_advantage;
     }
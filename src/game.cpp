@@ -31,7 +31,8 @@ namespace engine{
         current_state.next_event = {true, Action::Evaluating, Item::None};
         player->reset();
         dealer->reset();
-        std::tie(current_state.player.items, current_state.dealer.items) = item_drawer->getItems(current_state.max_lives, std::move(current_state.player.items), std::move(current_state.dealer.items));
+        std::tie(current_state.player.items, current_state.dealer.items) = item_drawer->getItems(current_state.max_lives, current_state.player.items.toVector(), current_state.dealer.items.toVector());
+        current_state.refreshKey();
     }
 
     void Game::playMove() {
@@ -39,6 +40,11 @@ namespace engine{
     }
 
     State Game::getSuccessor(State state) const{
+        // participants may use their items in any order
+        if(state.last_item != Item::None) {
+            state.last_item = Item::None;
+            state.refreshKey();
+        }
         auto children = StateMachine::getChildStates(state);
 
         // random events
@@ -100,7 +106,12 @@ namespace engine{
         
         // enumerate all options
         if(logging) std::cout << "There are " << left_rounds << " left rounds.\n";
+        bool reveals_known_round{false};
         for(unsigned int index = 1; index < left_rounds; ++index) {
+            if(state.shotgun.isRevealRedundant(index, StateMachine::isPlayerTurn(state))) {
+                reveals_known_round = true;
+                continue;
+            }
             const auto probability = StateMachine::getProbabilityOfBlankRound(state, children.front()->inverter_used, index);
             if(probability > parameters::EPSILON) {
                 if(logging) std::cout << available_option << ": Shell " << index + 1 << ": Blank round.\n";
@@ -111,6 +122,10 @@ namespace engine{
                 ++available_option;
             }
         }
+        if(reveals_known_round) {
+            if(logging) std::cout << available_option << ": An already known shell.\n";
+            ++available_option;
+        }
 
         // choose option
         assert(children.size() == available_option);
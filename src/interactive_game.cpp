@@ -6,8 +6,8 @@
 #include "engine/item_drawers/get_input_item_drawer.hpp"
 
 namespace {
-    void displayItems(const std::vector<engine::Item>& items) {
-        for (const auto& item : items) {
+    void displayItems(const engine::ItemSet& items) {
+        for (const auto item : items.toVector()) {
             std::cout << engine::toString(item) << " ";
         }
         std::cout << "\n";
@@ -119,8 +119,8 @@ namespace engine{
             const auto& current_state = getCurrentState();
             std::cout << "\nNEW GAME --------------------------------------------------\n";
             std::cout << "live rounds: " << current_state.shotgun.getRemainingLiveRounds() << ", blank rounds: " <<  current_state.shotgun.getRemainingBlankRounds()  << "\n";
-            std::cout << "dealer's lives: " << current_state.dealer.lives; 
-            std::cout << ", player's lives: " <<  current_state.player.lives << "\n";
+            std::cout << "dealer's lives: " << static_cast<unsigned int>(current_state.dealer.lives); 
+            std::cout << ", player's lives: " <<  static_cast<unsigned int>(current_state.player.lives) << "\n";
             std::cout << "dealer's items: ";
             displayItems(current_state.dealer.items);
             std::cout << "player's items: ";
@@ -164,8 +164,8 @@ namespace engine{
         std::cout << "Next event: " << toString(current_state.next_event) << ".\n";
         Game::playMove();
         const auto& new_state = getCurrentState();
-        std::cout << "dealer's lives: " << new_state.dealer.lives; 
-        std::cout << ", player's lives: " <<  new_state.player.lives << "\n";
+        std::cout << "dealer's lives: " << static_cast<unsigned int>(new_state.dealer.lives); 
+        std::cout << ", player's lives: " <<  static_cast<unsigned int>(new_state.player.lives) << "\n";
         std::cout << "Move finished.\n";
     }
 
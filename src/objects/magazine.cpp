@@ -5,141 +5,144 @@
 namespace engine{
 
     void Magazine::load(const unsigned int live_rounds, const unsigned int blank_rounds) {
-        total_live_rounds = unknown_live_rounds = live_rounds;
-        total_blank_rounds = unknown_blank_rounds = blank_rounds;
-        round_knowledge.clear();
-        for(unsigned int idx = 0; idx < live_rounds + blank_rounds; ++idx) {
-            round_knowledge.push_back({Round::Unknown, false});
-        }
-    }
-    
+        assert(live_rounds + blank_rounds <= game_parameters::MAX_SHELLS);
+        total_live_rounds = live_rounds;
+        total_blank_rounds = blank_rounds;
+        remaining_rounds = live_rounds + blank_rounds;
+        known_mask = live_mask = 0;
+        player_knowledge_mask = dealer_knowledge_mask = possible_dealer_knowledge_mask = 0;
+    }
+
     void Magazine::makeDealerKnowRound(const unsigned int index) {
-        assert(index < round_knowledge.size());
-        round_knowledge[index].dealer_knowledge = true;
+        assert(index < remaining_rounds);
+        dealer_knowledge_mask |= 1U << index;
     }
-    
+
     void Magazine::makeDealerPossiblyKnowRound(const unsigned int index) {
-        assert(index < round_knowledge.size());
-        round_knowledge[index].possible_dealer_knowledge = true;
+        assert(index < remaining_rounds);
+        possible_dealer_knowledge_mask |= 1U << index;
     }
-    
+
     void Magazine::makePlayerKnowRound(const unsigned int index) {
-        assert(index < round_knowledge.size());
-        round_knowledge[index].player_knowledge = true;
+        assert(index < remaining_rounds);
+        player_knowledge_mask |= 1U << index;
     }
 
     void Magazine::setBlankRound(const unsigned int index) {
-        assert(index < round_knowledge.size());
+        assert(index < remaining_rounds);
         assert(getProbabilityOfBlankRound(index) > parameters::EPSILON);
-        assert(round_knowledge[index].true_state != Round::LiveRound);
-        if(round_knowledge[index].true_state == Round::Unknown) {
-            --unknown_blank_rounds;
-            round_knowledge[index].true_state = Round::BlankRound;
-        }
+        assert(getTrueStateOfRound(index) != Round::LiveRound);
+        known_mask |= 1U << index;
     }
 
     void Magazine::setLiveRound(const unsigned int index) {
-        assert(index < round_knowledge.size());
+        assert(index < remaining_rounds);
         assert(1.0 - getProbabilityOfBlankRound(index) > parameters::EPSILON);
-        assert(round_knowledge[index].true_state != Round::BlankRound);
-        if(round_knowledge[index].true_state == Round::Unknown) {
-            --unknown_live_rounds;
-            round_knowledge[index].true_state = Round::LiveRound;
-        }
+        assert(getTrueStateOfRound(index) != Round::BlankRound);
+        known_mask |= 1U << index;
+        live_mask |= 1U << index;
     }
 
     void Magazine::ejectBlankRound() {
-        assert(!round_knowledge.empty());
+        assert(remaining_rounds);
         assert(total_blank_rounds);
         assert(getProbabilityOfBlankRound() > parameters::EPSILON);
-        if(round_knowledge.front().true_state == Round::Unknown) {
-            assert(unknown_blank_rounds);
-            --unknown_blank_rounds;
-        }
         --total_blank_rounds;
-        round_knowledge.pop_front();
+        --remaining_rounds;
+        known_mask >>= 1;
+        live_mask >>= 1;
+        player_knowledge_mask >>= 1;
+        dealer_knowledge_mask >>= 1;
+        possible_dealer_knowledge_mask >>= 1;
     }
 
     void Magazine::ejectLiveRound() {
-        assert(!round_knowledge.empty());
+        assert(remaining_rounds);
         assert(total_live_rounds);
         assert(1.0 - getProbabilityOfBlankRound() > parameters::EPSILON);
-        if(round_knowledge.front().true_state == Round::Unknown) {
-            assert(unknown_live_rounds);
-            --unknown_live_rounds;
-        }
         --total_live_rounds;
-        round_knowledge.pop_front();
+        --remaining_rounds;
+        known_mask >>= 1;
+        live_mask >>= 1;
+        player_knowledge_mask >>= 1;
+        dealer_knowledge_mask >>= 1;
+        possible_dealer_knowledge_mask >>= 1;
     }
 
     void Magazine::convertBlankRound() {
-        assert(!round_knowledge.empty());
+        assert(remaining_rounds);
         assert(total_blank_rounds);
         assert(getProbabilityOfBlankRound() > parameters::EPSILON);
-        if(round_knowledge.front().true_state == Round::Unknown) {
-            assert(unknown_blank_rounds);
-            --unknown_blank_rounds;
-        }
         --total_blank_rounds;
         ++total_live_rounds;
-        round_knowledge.front().true_state = Round::LiveRound;
+        known_mask |= 1U;
+        live_mask |= 1U;
     }
 
     void Magazine::convertLiveRound() {
-        assert(!round_knowledge.empty());
+        assert(remaining_rounds);
         assert(total_live_rounds);
         assert(1.0 - getProbabilityOfBlankRound() > parameters::EPSILON);
-        if(round_knowledge.front().true_state == Round::Unknown) {
-            assert(unknown_live_rounds);
-            --unknown_live_rounds;
-        }
         --total_live_rounds;
         ++total_blank_rounds;
-        round_knowledge.front().true_state = Round::BlankRound;
+        known_mask |= 1U;
+        live_mask &= ~1U;
     }
-    
+
     bool Magazine::couldDealerKnowRound(const unsigned int index) const{
-        return round_knowledge[index].possible_dealer_knowledge || (round_knowledge[index].dealer_knowledge && (round_knowledge[index].true_state == Round::Unknown));
+        const uint8_t hidden_dealer_knowledge = dealer_knowledge_mask & ~known_mask;
+        return ((possible_dealer_knowledge_mask | hidden_dealer_knowledge) >> index) & 1U;
+    }
+
+    bool Magazine::isRevealRedundant(const unsigned int index, const bool to_player) const{
+        const Round knowledge = to_player ? getPlayerKnowledgeOfRound(index) : getDealerKnowledgeOfRound(index);
+        if(knowledge == Round::Unknown) return false;
+        // marking the round as known would hide that the dealer could know it
+        const uint8_t hidden_dealer_knowledge = dealer_knowledge_mask & ~known_mask;
+        return !((hidden_dealer_knowledge >> index) & 1U);
     }
-    
+
     Round Magazine::getDealerKnowledgeOfRound(const unsigned int index) const{
-        assert(index < round_knowledge.size());
-        if(round_knowledge[index].dealer_knowledge) return round_knowledge[index].true_state;
-        unsigned int dealer_unknown_blank_rounds = unknown_blank_rounds;
-        unsigned int dealer_unknown_live_rounds = unknown_live_rounds;
-        for(unsigned int idx = 0; idx < round_knowledge.size(); ++idx) {
-            if(!round_knowledge[idx].dealer_knowledge) {
-                if(round_knowledge[idx].true_state == Round::BlankRound) ++dealer_unknown_blank_rounds;
-                if(round_knowledge[idx].true_state == Round::LiveRound) ++dealer_unknown_live_rounds;
-            }
-        }
-        if(!dealer_unknown_live_rounds) return Round::BlankRound;
-        if(!dealer_unknown_blank_rounds) return Round::LiveRound;
-        return Round::Unknown;
+        return getKnowledgeOfRound(index, dealer_knowledge_mask);
     }
-    
+
     Round Magazine::getPlayerKnowledgeOfRound(const unsigned int index) const{
-        assert(index < round_knowledge.size());
-        if(round_knowledge[index].player_knowledge) return round_knowledge[index].true_state;
-        unsigned int player_unknown_blank_rounds = unknown_blank_rounds;
-        unsigned int player_unknown_live_rounds = unknown_live_rounds;
-        for(unsigned int idx = 0; idx < round_knowledge.size(); ++idx) {
-            if(!round_knowledge[idx].player_knowledge) {
-                if(round_knowledge[idx].true_state == Round::BlankRound) ++player_unknown_blank_rounds;
-                if(round_knowledge[idx].true_state == Round::LiveRound) ++player_unknown_live_rounds;
-            }
-        }
-        if(!player_unknown_live_rounds) return Round::BlankRound;
-        if(!player_unknown_blank_rounds) return Round::LiveRound;
+        return getKnowledgeOfRound(index, player_knowledge_mask);
+    }
+
+    Round Magazine::getKnowledgeOfRound(const unsigned int index, const uint8_t knowledge_mask) const{
+        assert(index < remaining_rounds);
+        if((knowledge_mask >> index) & 1U) return getTrueStateOfRound(index);
+        // rounds whose type is not known to the participant
+        const unsigned int unknown_blank_rounds = total_blank_rounds - __builtin_popcount(known_mask & ~live_mask & knowledge_mask);
+        const unsigned int unknown_live_rounds = total_live_rounds - __builtin_popcount(known_mask & live_mask & knowledge_mask);
+        if(!unknown_live_rounds) return Round::BlankRound;
+        if(!unknown_blank_rounds) return Round::LiveRound;
         return Round::Unknown;
     }
 
     double Magazine::getProbabilityOfBlankRound(const unsigned int index) const{
-        assert(!round_knowledge.empty());
-        assert(index < round_knowledge.size());
-        // consider if the first round is known
-        if(round_knowledge[index].true_state == Round::BlankRound) return 1.0;
-        if(round_knowledge[index].true_state == Round::LiveRound) return 0.0;
-        return unknown_blank_rounds / static_cast<double>(unknown_live_rounds + unknown_blank_rounds);
+        assert(remaining_rounds);
+        assert(index < remaining_rounds);
+        // consider if the round is known
+        if((known_mask >> index) & 1U) return ((live_mask >> index) & 1U) ? 0.0 : 1.0;
+        const unsigned int unknown_blank_rounds = getUnknownBlankRounds();
+        return unknown_blank_rounds / static_cast<double>(getUnknownLiveRounds() + unknown_blank_rounds);
+    }
+
+    Round Magazine::getTrueStateOfRound(const unsigned int index) const{
+        assert(index < remaining_rounds);
+        if(!((known_mask >> index) & 1U)) return Round::Unknown;
+        return ((live_mask >> index) & 1U) ? Round::LiveRound : Round::BlankRound;
+    }
+
+    bool Magazine::operator==(const Magazine& other) const {
+        return (remaining_rounds == other.remaining_rounds) &
+               (total_live_rounds == other.total_live_rounds) &
+               (total_blank_rounds == other.total_blank_rounds) &
+               (known_mask == other.known_mask) &
+               ((live_mask & known_mask) == (other.live_mask & other.known_mask)) &
+               (player_knowledge_mask == other.player_knowledge_mask) &
+               (dealer_knowledge_mask == other.dealer_knowledge_mask);
     }
 }
\ No newline at end of file
@@ -2,12 +2,7 @@
 
 namespace engine{
     void Participant::removeItem(Item item){    
-        auto it = std::find(items.begin(), items.end(), item);
-        if (it != items.end()) {
-            items.erase(it);
-        } else {
-            throw std::runtime_error("No elements of type VariantA found");
-        }
+        items.remove(item);
     }
 
     void Participant::loseLife() {
@@ -21,28 +16,18 @@ namespace engine{
 
     std::pair<std::bitset<32>, uint32_t> Participant::getHash(const int max_slots) const{
 
-        // leading two bits for the lives
+        // lowest four bits are reserved, followed by three bits for the lives
         uint32_t hash = lives << 4;
 
-        // Construct the hash
-        for (const auto& item : items) {
-            hash = hash ^ static_cast<int>(item);
-        }
+        // scramble the packed item counters into the remaining bits
+        constexpr uint64_t multiplier{0x9E3779B97F4A7C15ULL};
+        hash |= static_cast<uint32_t>((items.getCounts() * multiplier) >> 39) << 7;
 
-        // size should be 8 item bits + 9 zero bits + 2 live bits = 19
-        return {hash, 6};
+        // size should be 4 zero bits + 3 live bits + 25 item bits = 32
+        return {hash, 32};
     }
 
     bool Participant::operator==(const Participant& other) const {
-        if(lives != other.lives) return false;
-        if(items.size() != other.items.size()) return false;
-        auto this_items = items;
-        std::sort(this_items.begin(), this_items.end());
-        auto other_items = other.items;
-        std::sort(other_items.begin(), other_items.end());
-        for (int i = 0; i < items.size(); ++i) {
-            if(this_items[i] != other_items[i]) return false;
-        }
-        return true;
+        return (lives == other.lives) & (items == other.items);
     }
 }
\ No newline at end of file
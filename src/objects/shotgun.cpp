@@ -32,23 +32,17 @@ namespace engine{
 
     std::pair<std::bitset<32>, uint32_t> Shotgun::getHash(const int max_shots) const{
 
-        // leading two bits for the lives
-        std::bitset<32> hash;
-        for(int i = 0; i < round_knowledge.size(); ++i){
-            if(round_knowledge[i].getHash()) hash.set(i);
-        }
+        // one bit per remaining round
+        const uint32_t valid_rounds = (1U << remaining_rounds) - 1;
+        const uint32_t known_live_rounds = known_mask & live_mask;
+        std::bitset<32> hash((player_knowledge_mask ^ dealer_knowledge_mask ^ ~known_live_rounds) & valid_rounds);
         if(sawed_off) hash.set(max_shots);
 
         return {hash, max_shots + 1};
     }
 
     bool Shotgun::operator==(const Shotgun& other) const {
-        if(unknown_blank_rounds != other.unknown_blank_rounds) return false;
-        if(unknown_live_rounds != other.unknown_live_rounds) return false;
-        if(round_knowledge.size() != other.round_knowledge.size()) return false;
-        for(int i = 0; i < round_knowledge.size(); ++i){
-            if(round_knowledge[i] != other.round_knowledge[i]) return false;
-        }
+        if(!Magazine::operator==(other)) return false;
         return sawed_off == other.isSawedOff();
     }
 }
\ No newline at end of file
@@ -1,4 +1,45 @@
 #include "engine/objects/state.hpp"
+#include "engine/objects/zobrist.hpp"
+#include <cassert>
+
+namespace {
+    using engine::zobrist::KEYS;
+
+    uint64_t getParticipantKeyDiff(const unsigned int side, const engine::Participant& from, const engine::Participant& to) {
+        assert(from.lives < engine::zobrist::LIVES_RANGE && to.lives < engine::zobrist::LIVES_RANGE);
+        uint64_t diff = KEYS.lives[side][from.lives] ^ KEYS.lives[side][to.lives];
+        // visit only the item counters that changed
+        const uint64_t from_counts = from.items.getCounts();
+        const uint64_t to_counts = to.items.getCounts();
+        uint64_t changed = from_counts ^ to_counts;
+        while(changed) {
+            const unsigned int index = __builtin_ctzll(changed) / engine::ItemSet::BITS_PER_ITEM;
+            const unsigned int shift = index * engine::ItemSet::BITS_PER_ITEM;
+            diff ^= KEYS.items[side][index][(from_counts >> shift) & engine::ItemSet::COUNTER_MASK];
+            diff ^= KEYS.items[side][index][(to_counts >> shift) & engine::ItemSet::COUNTER_MASK];
+            changed &= ~(engine::ItemSet::COUNTER_MASK << shift);
+        }
+        return diff;
+    }
+
+    // the bitboards are keyed as a whole since ejecting a round shifts every slot
+    uint64_t getShotgunKey(const engine::Shotgun& shotgun) {
+        uint64_t key = KEYS.shells[shotgun.total_live_rounds][shotgun.total_blank_rounds];
+        key ^= KEYS.known_rounds[shotgun.known_mask];
+        key ^= KEYS.live_rounds[shotgun.live_mask & shotgun.known_mask];
+        key ^= KEYS.player_knowledge[shotgun.player_knowledge_mask];
+        key ^= KEYS.dealer_knowledge[shotgun.dealer_knowledge_mask];
+        return shotgun.isSawedOff() ? key ^ KEYS.saw : key;
+    }
+
+    uint64_t getEventKey(const engine::Event& event) {
+        uint64_t key = KEYS.actions[static_cast<unsigned int>(event.action)];
+        if(event.is_player_turn) key ^= KEYS.player_turn;
+        // the item is only part of the event when it is used
+        if(event.action == engine::Action::UseItem) key ^= KEYS.event_items[static_cast<unsigned int>(event.item)];
+        return key;
+    }
+}
 
 namespace engine{
     void State::switchParticipantIfNotCuffed() {
@@ -29,12 +70,37 @@ namespace engine{
         return next_event.is_player_turn? dealer : player;
     }
 
+    uint64_t State::computeKey() const {
+        State state{*this};
+        state.updateKey(State{});
+        return state.key;
+    }
+
+    void State::refreshKey() {
+        key = computeKey();
+    }
+
+    void State::updateKey(const State& parent) {
+        key = parent.key;
+        key ^= getParticipantKeyDiff(0, parent.player, player);
+        key ^= getParticipantKeyDiff(1, parent.dealer, dealer);
+        key ^= getShotgunKey(parent.shotgun) ^ getShotgunKey(shotgun);
+        key ^= KEYS.handcuffs[parent.handcuffs.getType()] ^ KEYS.handcuffs[handcuffs.getType()];
+        key ^= getEventKey(parent.next_event) ^ getEventKey(next_event);
+        if(parent.inverter_used != inverter_used) key ^= KEYS.inverter;
+        key ^= KEYS.last_items[static_cast<unsigned int>(parent.last_item)] ^ KEYS.last_items[static_cast<unsigned int>(last_item)];
+        assert(parent.max_lives < zobrist::LIVES_RANGE && max_lives < zobrist::LIVES_RANGE);
+        key ^= KEYS.max_lives[parent.max_lives] ^ KEYS.max_lives[max_lives];
+    }
+
     bool State::operator==(const State& other) const {
         return (dealer == other.dealer) && 
         (player == other.player) &&
         (max_lives == other.max_lives) &&
         (shotgun == other.shotgun) &&
         (handcuffs == other.handcuffs) &&
+        (inverter_used == other.inverter_used) &&
+        (last_item == other.last_item) &&
         (next_event == other.next_event);
     }
 }
\ No newline at end of file
@@ -6,11 +6,21 @@
 #include "randomizer.hpp"
 #include <future>
 #include <atomic>
+#include <limits>
 
 namespace {
-    std::pair<int, int> playGames(unsigned int num_games_to_play, unsigned int seed) {
+    struct Statistics {
+        int wins{0};
+        int losses{0};
+        std::size_t searches{0};
+        double search_seconds{0.0};
+    };
+
+    Statistics playGames(unsigned int num_games_to_play, unsigned int seed, const search::SearchLimits& limits) {
         std::unique_ptr<randomizer::TrueRandomizer<engine::State>> randomizer = std::make_unique<randomizer::TrueRandomizer<engine::State>>();
-        std::unique_ptr<engine::AutomaticIntelligentAgent> player = std::make_unique<engine::AutomaticIntelligentAgent>();
+        std::unique_ptr<engine::AutomaticIntelligentAgent> player = std::make_unique<engine::AutomaticIntelligentAgent>(limits);
+        // the game owns the player, its search statistics are read after the games
+        const engine::AutomaticIntelligentAgent& searcher = *player;
         std::unique_ptr<engine::RandomizedAgent> dealer = std::make_unique<engine::RandomizedAgent>();
         dealer->setSeed(seed);
         std::unique_ptr<engine::RandomizedItemDrawer> item_drawer = std::make_unique<engine::RandomizedItemDrawer>();
@@ -36,7 +46,7 @@ namespace {
         }
 
         std::cout << "Thread finished.\n";
-        return {wins, losses};
+        return {wins, losses, searcher.search_count, searcher.search_seconds};
     }
 }
 
@@ -56,37 +66,44 @@ int main(int argc, char* argv[]){				// argc = number of arguments, argv = array
     if(argc > 3) {
         seed = strtoul(argv[3], &argv[3], 10);
     }
+    search::SearchLimits limits{};
+    if(argc > 4) {
+        // a fixed number of nodes per search instead of a time limit makes the work per move reproducible
+        limits = search::SearchLimits{std::numeric_limits<double>::infinity(), strtoull(argv[4], &argv[4], 10)};
+    }
     std::cout << "seed used: " << seed << "\n";
+    if(limits.node_limit) std::cout << "node limit per search: " << limits.node_limit << "\n";
 
-    int total_wins = 0;
-    int total_losses = 0;
+    Statistics total;
     auto start = std::chrono::high_resolution_clock::now();
 
-    if(false /*num_threads > 1*/) {
-        // TODO: fix multithreading
-        // 1. atomic free_threads must not be a static variable
-        // 2. fix deadlock situation with the timeout
-        engine::AutomaticIntelligentAgent::Search::free_threads.store(num_threads);
-        std::vector<std::future<std::pair<int, int>>> futures;
+    if(num_threads > 1) {
+        // every thread plays its own games, each search is cancelled on its own
+        engine::AutomaticIntelligentAgent::Search::free_threads.store(1);
+        std::vector<std::future<Statistics>> futures;
         for (int i = 0; i < num_threads; ++i) {
-            futures.push_back(std::async(std::launch::async, playGames, num_games_to_play, seed + i));
+            futures.push_back(std::async(std::launch::async, playGames, num_games_to_play, seed + i, limits));
         }
         for (auto& future : futures) {
-            auto result = future.get();
-            total_wins += result.first;
-            total_losses += result.second;
+            const Statistics result = future.get();
+            total.wins += result.wins;
+            total.losses += result.losses;
+            total.searches += result.searches;
+            total.search_seconds += result.search_seconds;
         }
     } else {
         engine::AutomaticIntelligentAgent::Search::free_threads.store(num_threads);
-        std::tie(total_wins, total_losses) = playGames(num_games_to_play, seed);
+        total = playGames(num_games_to_play, seed, limits);
     }
     auto end = std::chrono::high_resolution_clock::now();
     const std::chrono::duration<double> elapsed = end - start;
     std::cout << "Time of execution: " << elapsed.count() << " seconds." << std::endl;
     std::cout << "Execution time per game: " << elapsed.count()/static_cast<double>(num_games_to_play*num_threads) << " seconds." << std::endl;
-    std::cout << "Total Wins: " << total_wins << "\n";
-    std::cout << "Total Losses: " << total_losses << "\n";
-    std::cout << "Win probability: " << static_cast<double>(100*total_wins)/static_cast<double>(total_losses + total_wins) << " %\n";
+    std::cout << "Searches: " << total.searches << "\n";
+    if(total.searches) std::cout << "Search time per move: " << total.search_seconds/static_cast<double>(total.searches) << " seconds." << std::endl;
+    std::cout << "Total Wins: " << total.wins << "\n";
+    std::cout << "Total Losses: " << total.losses << "\n";
+    std::cout << "Win probability: " << static_cast<double>(100*total.wins)/static_cast<double>(total.losses + total.wins) << " %\n";
 
 	return 0;
 }
\ No newline at end of file
@@ -3,6 +3,25 @@
 #include "parameters.hpp"
 #include <string>
 #include <cassert>
+#include <new>
+#include <type_traits>
+#include <numeric>
+#include <algorithm>
+
+namespace {
+    // deterministic items whose effects do not depend on each other
+    bool isCommutativeItem(const engine::Item item) {
+        switch(item) {
+            case engine::Item::Cigarette:
+            case engine::Item::Saw:
+            case engine::Item::Handcuffs:
+            case engine::Item::Inverter:
+                return true;
+            default:
+                return false;
+        }
+    }
+}
 
 namespace engine{
     bool StateMachine::isFinished(const State& state){
@@ -32,60 +51,147 @@ namespace engine{
         return max_depth;
     }
 
+    bool StateMachine::hasUsableOpponentItem(const State& state){
+        if(state.getOpponent().items.empty()) return false;
+        MoveList opponent_item_moves;
+        addEvaluatingMoves(state, opponent_item_moves, true);
+        return !opponent_item_moves.empty();
+    }
+
+    std::size_t StateMachine::countChildren(const State& state){
+        MoveList moves;
+        generateMoves(state, moves);
+        return moves.size();
+    }
+
+    bool StateMachine::isForcedMove(const State& state){
+        return countChildren(state) == 1;
+    }
+
     std::vector<std::unique_ptr<State>> StateMachine::getChildStates(const State& parent){
-        assert(!isFinished(parent));
+        MoveList moves;
+        generateMoves(parent, moves);
+        std::vector<std::unique_ptr<State>> children{};
+        children.reserve(moves.size());
+        for(const auto& move : moves) {
+            auto child = std::make_unique<State>(parent);
+            apply(*child, move);
+            children.push_back(std::move(child));
+        }
+        return children;
+    }
+
+    arena::Span<State> StateMachine::getChildStates(const State& parent, arena::Arena& memory){
+        MoveList moves;
+        generateMoves(parent, moves);
+        // the arena never runs destructors
+        static_assert(std::is_trivially_destructible_v<State>);
+        State* children = memory.allocate<State>(moves.size());
+        for(std::size_t index = 0; index < moves.size(); ++index) {
+            new (children + index) State{parent};
+            apply(children[index], moves[index]);
+        }
+        return {children, moves.size()};
+    }
+
+    StateMachine::ChildGenerator::ChildGenerator(const State& parent) : parent(parent) {
+        generateMoves(parent, moves);
+        std::iota(order.begin(), order.begin() + moves.size(), 0);
+    }
+
+    State StateMachine::ChildGenerator::next(){
+        assert(hasNext());
+        State child{parent};
+        apply(child, moves[order[index++]]);
+        return child;
+    }
+
+    void StateMachine::ChildGenerator::prioritize(const std::size_t move_index){
+        assert(!index);
+        const auto end = order.begin() + moves.size();
+        const auto position = std::find(order.begin(), end, move_index);
+        // the others keep their order
+        if(position != end) std::rotate(order.begin(), position, position + 1);
+    }
+
+    void StateMachine::generateMoves(const State& state, MoveList& moves){
+        assert(!isFinished(state));
+        moves.clear();
         // decide by choice
-        switch (parent.next_event.action) {
+        switch (state.next_event.action) {
+            case Action::Evaluating:
+                addEvaluatingMoves(state, moves);
+                break;
+            case Action::ShootSelf:
+            case Action::ShootOther:
+                addRoundMoves(state, moves);
+                break;
+            case Action::UseItem:
+                addUseItemMoves(state, moves);
+                break;
+            default:
+                throw std::runtime_error("Unknown action type in generateMoves");
+        }
+        assert(!moves.empty());
+    }
+
+    StateMachine::Undo StateMachine::apply(State& state, const Move& move){
+        Undo record{state};
+        switch (state.next_event.action) {
             case Action::Evaluating:
-                return getEvaluatingChildStates(parent);
+                applyDecision(state, move);
+                break;
             case Action::ShootSelf:
-                return getShootSelfChildStates(parent);
+                applyShootSelf(state, move);
+                break;
             case Action::ShootOther:
-                return getShootOtherChildStates(parent);
+                applyShootOther(state, move);
+                break;
             case Action::UseItem:
-                return getUseItemChildStates(parent);
+                applyUseItem(state, move);
+                break;
             default:
-                throw std::runtime_error("Unknown action type in getChildStates");
+                throw std::runtime_error("Unknown action type in apply");
         }
+        state.updateKey(record);
+        return record;
     }
 
-    std::vector<std::unique_ptr<State>> StateMachine::getEvaluatingChildStates(const State& parent, const bool use_opponent_items){
+    void StateMachine::addEvaluatingMoves(const State& state, MoveList& moves, const bool use_opponent_items){
         if constexpr (parameters::DEALER_USES_PLAYER_LOGIC) {
-            return getPlayerEvaluatingChildStates(parent, use_opponent_items);
+            addPlayerEvaluatingMoves(state, moves, use_opponent_items);
+            return;
         }
 
-        if(isPlayerTurn(parent)) {
-            return getPlayerEvaluatingChildStates(parent, use_opponent_items);
+        if(isPlayerTurn(state)) {
+            addPlayerEvaluatingMoves(state, moves, use_opponent_items);
         } else {
-            return getDealerEvaluatingChildStates(parent, use_opponent_items);
+            addDealerEvaluatingMoves(state, moves, use_opponent_items);
         }
     }
 
-    std::vector<std::unique_ptr<State>> StateMachine::getPlayerEvaluatingChildStates(const State& parent, const bool use_opponent_items){
+    void StateMachine::addPlayerEvaluatingMoves(const State& state, MoveList& moves, const bool use_opponent_items){
 
-        std::array<bool, game_parameters::ITEMS + 1> items_not_to_consider{};
-        const bool is_last_round = parent.shotgun.getRemainingRounds() < 2;
-        auto& participant = parent.getActiveParticipant();
-        auto& opponent = parent.getOpponent();
+        const bool is_last_round = state.shotgun.getRemainingRounds() < 2;
+        const bool is_player_turn = isPlayerTurn(state);
+        auto& participant = state.getActiveParticipant();
+        auto& opponent = state.getOpponent();
 
-        Round known_shell = parent.shotgun.getPlayerKnowledgeOfRound();
-        if(parent.inverter_used) {
+        Round known_shell = state.shotgun.getPlayerKnowledgeOfRound();
+        if(state.inverter_used) {
             if(known_shell == Round::BlankRound) known_shell = Round::LiveRound;
             else if(known_shell == Round::LiveRound) known_shell = Round::BlankRound;
         }
-        bool dont_shoot_self = parent.shotgun.isSawedOff() || ((known_shell == Round::LiveRound) && (participant.lives < 2));
+        bool dont_shoot_self = state.shotgun.isSawedOff() || ((known_shell == Round::LiveRound) && (participant.lives < 2));
 
-        // add children
-        std::vector<std::unique_ptr<State>> children{};
-
-        // add items
+        // add items (each distinct item once)
         for (const auto item : (use_opponent_items ? opponent.items : participant.items)){
             // only consider the items that the player currently owns
             assert(item != Item::None);
             assert(item != Item::Count);
-            // don't add already used items
-            if(items_not_to_consider[static_cast<unsigned int>(item)]) continue;
-            items_not_to_consider[static_cast<unsigned int>(item)] = true;
+
+            // any order of commutative items reaches the same state, only the ascending one is used
+            if(isCommutativeItem(item) && item < state.last_item) continue;
 
             // apply some simplification rules
             switch(item) {
@@ -93,10 +199,10 @@ namespace engine{
                     if(known_shell != Round::Unknown) continue;
                     break;
                 case Item::Saw:
-                    if(opponent.lives < 2 || parent.shotgun.isSawedOff()) continue;
+                    if(opponent.lives < 2 || state.shotgun.isSawedOff()) continue;
                     break;
                 case Item::Handcuffs:
-                    if(!parent.handcuffs.isAllowedToAdd() || is_last_round) continue;
+                    if(!state.handcuffs.isAllowedToAdd() || is_last_round) continue;
                     break;
                 case Item::Phone:
                     if(is_last_round) continue;
@@ -109,60 +215,43 @@ namespace engine{
                     // if the next round is uncertain two inverters will result
                     // in a weird scenario where the next round is "guaranteed"
                     // to be live when in fact it is not.
-                    if(parent.inverter_used) continue;
+                    if(state.inverter_used) continue;
                     break;
                 case Item::Adrenalin:
-                    if(use_opponent_items || getAdrenalinChildStates(parent).empty()) continue;
+                    if(use_opponent_items || !hasUsableOpponentItem(state)) continue;
                     break;
                 case Item::Pills:
                 default:
                     break;
             }
 
-            auto child = std::make_unique<State>(parent);
-            child->next_event.item = item;
-            child->next_event.action = Action::UseItem;
-            if(use_opponent_items) {
-                child->getOpponent().removeItem(item);
-            } else {
-                child->getActiveParticipant().removeItem(item);
-            }
-            children.push_back(std::move(child));
+            moves.push_back(Move{1.0, {is_player_turn, Action::UseItem, item}});
         }
 
         // adrenalin use forbids shooting options
-        if(use_opponent_items) return children; // adrenalin checks if this is empty
+        if(use_opponent_items) return; // adrenalin checks if this is empty
 
         // shoot self or opponent
         if(!dont_shoot_self){
-            auto child = std::make_unique<State>(parent);
-            child->next_event.action = Action::ShootSelf;
-            children.push_back(std::move(child));
-        }
-        if(!use_opponent_items){
-            auto child = std::make_unique<State>(parent);
-            child->next_event.action = Action::ShootOther;
-            children.push_back(std::move(child));
+            moves.push_back(Move{1.0, {is_player_turn, Action::ShootSelf}});
         }
-
-        assert(!children.empty());
-        return children;
+        moves.push_back(Move{1.0, {is_player_turn, Action::ShootOther}});
     }
 
-    std::vector<std::unique_ptr<State>> StateMachine::getDealerEvaluatingChildStates(const State& parent, const bool use_opponent_items){
-        assert(!isPlayerTurn(parent));
-        std::array<bool, game_parameters::ITEMS + 1> items_not_to_consider{};
-        const bool is_last_round = parent.shotgun.getRemainingRounds() < 2;
-        const bool has_max_health = parent.dealer.lives == parent.max_lives;
+    void StateMachine::addDealerEvaluatingMoves(const State& state, MoveList& moves, const bool use_opponent_items){
+        assert(!isPlayerTurn(state));
+        const bool is_last_round = state.shotgun.getRemainingRounds() < 2;
+        const bool has_max_health = state.dealer.lives == state.max_lives;
+        const std::size_t first_move = moves.size();
 
-        bool consider_shooting_self{!parent.shotgun.isSawedOff()}, consider_shooting_other{true};
-        Round known_shell = parent.shotgun.getDealerKnowledgeOfRound();
-        if(parent.inverter_used) {
+        bool consider_shooting_self{!state.shotgun.isSawedOff()}, consider_shooting_other{true};
+        Round known_shell = state.shotgun.getDealerKnowledgeOfRound();
+        if(state.inverter_used) {
             if(known_shell == Round::BlankRound) known_shell = Round::LiveRound;
             else if(known_shell == Round::LiveRound) known_shell = Round::BlankRound;
         }
         // if the dealer uses the phone / glass but the player can't see the result
-        bool may_know_round = parent.shotgun.couldDealerKnowRound();
+        bool may_know_round = state.shotgun.couldDealerKnowRound();
         if(known_shell == Round::LiveRound) {
             consider_shooting_self = false;
         } else if(known_shell == Round::BlankRound) {
@@ -170,29 +259,23 @@ namespace engine{
         } else if(!may_know_round) {
             // implement the original "CoinFlip()"" function which
             // is not a coin flip for endless mode
-            const unsigned int blank_count = parent.shotgun.getRemainingBlankRounds();
-            const unsigned int live_count = parent.shotgun.getRemainingLiveRounds();
+            const unsigned int blank_count = state.shotgun.getRemainingBlankRounds();
+            const unsigned int live_count = state.shotgun.getRemainingLiveRounds();
             if(blank_count > live_count) consider_shooting_other = false;
             if(blank_count < live_count) consider_shooting_self = false;
             // else is actual coin flip
         }
 
-        // add children
-        std::vector<std::unique_ptr<State>> children{};
-
         // check for saws and cigarettes
-        const auto& items = use_opponent_items ? parent.player.items : parent.dealer.items;
-        bool has_cigs = std::find(items.begin(), items.end(), Item::Cigarette) != items.end();
+        const auto& items = use_opponent_items ? state.player.items : state.dealer.items;
+        bool has_cigs = items.contains(Item::Cigarette);
         bool has_saw_to_use{false};
 
-        // add items
-        for (const auto& item : items){
+        // add items (each distinct item once)
+        for (const auto item : items){
             // only consider the items that the player currently owns
             assert(item != Item::None);
             assert(item != Item::Count);
-            // don't add already used items
-            if(items_not_to_consider[static_cast<unsigned int>(item)]) continue;
-            items_not_to_consider[static_cast<unsigned int>(item)] = true;
 
             // apply some simplification rules
             switch(item) {
@@ -203,331 +286,303 @@ namespace engine{
                     if(!has_max_health) break;
                     continue;
                 case Item::Pills:
-                    if(!has_max_health && !has_cigs && (parent.dealer.lives != 1)) break;
+                    if(!has_max_health && !has_cigs && (state.dealer.lives != 1)) break;
                     continue;
                 case Item::Beer:
                     if(known_shell != Round::LiveRound && !is_last_round) break;
                     continue;
                 case Item::Handcuffs:
-                    if(parent.handcuffs.isAllowedToAdd() && !is_last_round) break;
+                    if(state.handcuffs.isAllowedToAdd() && !is_last_round) break;
                     continue;
                 case Item::Saw:
                     // (known_shell == Round::LiveRound || may_know_round) are covered by consider_shooting_other
-                    if(consider_shooting_other && !parent.shotgun.isSawedOff()) {
+                    if(consider_shooting_other && !state.shotgun.isSawedOff()) {
                         has_saw_to_use = true;
                         consider_shooting_other = false;
                         break;
                     }
                     continue;
                 case Item::Phone:
-                    if(parent.shotgun.getRemainingRounds() > 2) break;
+                    if(state.shotgun.getRemainingRounds() > 2) break;
                     continue;
                 case Item::Inverter:
-                    if((known_shell == Round::BlankRound || may_know_round) && !parent.inverter_used) break;
+                    if((known_shell == Round::BlankRound || may_know_round) && !state.inverter_used) break;
                     continue;
                 case Item::Adrenalin:
-                    if(use_opponent_items || getAdrenalinChildStates(parent).empty()) continue;
+                    if(use_opponent_items || !hasUsableOpponentItem(state)) continue;
                     break;
                 default:
                     break;
             }
 
-            auto child = std::make_unique<State>(parent);
-            child->next_event.item = item;
-            child->next_event.action = Action::UseItem;
-            if(use_opponent_items) {
-                child->getOpponent().removeItem(item);
-            } else {
-                child->getActiveParticipant().removeItem(item);
-            }
-            children.push_back(std::move(child));
+            moves.push_back(Move{1.0, {false, Action::UseItem, item}});
         }
 
         // adrenalin use forbids shooting options
-        if(use_opponent_items) return children; // adrenalin checks if this is empty
+        if(use_opponent_items) return; // adrenalin checks if this is empty
 
-        assert(consider_shooting_other || consider_shooting_self || !children.empty());
+        const bool has_item_moves = moves.size() > first_move;
+        // the round turned out to be blank after sawing off the shotgun, the saw is wasted on the dealer
+        if(!consider_shooting_other && !consider_shooting_self && !has_item_moves) consider_shooting_self = true;
         // dealer shoots only if no more usable items exist or might know the round
-        if(children.empty() || has_saw_to_use || may_know_round) {
+        if(!has_item_moves || has_saw_to_use || may_know_round) {
             if(consider_shooting_self){
-                auto child = std::make_unique<State>(parent);
-                child->next_event.action = Action::ShootSelf;
-                children.push_back(std::move(child));
+                moves.push_back(Move{1.0, {false, Action::ShootSelf}});
             }
             // dealer will saw before shooting when possible
             if(consider_shooting_other){
-                auto child = std::make_unique<State>(parent);
-                child->next_event.action = Action::ShootOther;
-                children.push_back(std::move(child));
+                moves.push_back(Move{1.0, {false, Action::ShootOther}});
             }
-            assert(!children.empty());
         }
+        assert(moves.size() > first_move);
+    }
 
-        assert(!children.empty());
-        return children;
+    void StateMachine::addRoundMoves(const State& state, MoveList& moves, const unsigned int index, const double probability){
+        const double blank_probability = state.shotgun.getProbabilityOfBlankRound(index);
+        if(std::abs(blank_probability) > parameters::EPSILON) {
+            moves.push_back(Move{probability * blank_probability, {}, Outcome::BlankRound, static_cast<uint8_t>(index)});
+        }
+        const double live_probability = 1.0 - blank_probability;
+        if(std::abs(live_probability) > parameters::EPSILON) {
+            moves.push_back(Move{probability * live_probability, {}, Outcome::LiveRound, static_cast<uint8_t>(index)});
+        }
     }
 
-    std::vector<std::unique_ptr<State>> StateMachine::getShootSelfChildStates(const State& parent){
-        std::vector<std::unique_ptr<State>> children{};
+    void StateMachine::addUseItemMoves(const State& state, MoveList& moves){
+        // items without a random outcome are followed by the next decision
+        State intermediate{state};
+        // decide by choice
+        switch (state.next_event.item) {
+            case Item::Cigarette:
+                useCigarette(intermediate);
+                return addEvaluatingMoves(intermediate, moves);
+            case Item::Glass:
+            case Item::Beer:
+                return addRoundMoves(state, moves);
+            case Item::Saw:
+                useSaw(intermediate);
+                return addEvaluatingMoves(intermediate, moves);
+            case Item::Handcuffs:
+                useHandcuffs(intermediate);
+                return addEvaluatingMoves(intermediate, moves);
+            case Item::Phone:
+                return addPhoneMoves(state, moves);
+            case Item::Pills:
+                // 50% chance to lose 1 health or to gain 2 health (unless max health is already reached)
+                moves.push_back(Move{0.5, {}, Outcome::LoseLife});
+                moves.push_back(Move{0.5, {}, Outcome::GainLives});
+                return;
+            case Item::Inverter:
+                useInverter(intermediate);
+                return addEvaluatingMoves(intermediate, moves);
+            case Item::Adrenalin:
+                return addEvaluatingMoves(state, moves, true);
+            default:
+                throw std::runtime_error("Unknown item type when trying to use an item");
+        }
+    }
 
-        double probability = parent.shotgun.getProbabilityOfBlankRound();
-        if(std::abs(probability) > parameters::EPSILON) {
-            // blank round
-            auto child = std::make_unique<State>(parent);
-            child->probability = probability;
-            if(parent.inverter_used) {
-                child->shotgun.convertBlankRound();
-                child->shotgun.shootLiveRound(child->getActiveParticipant());
-                child->switchParticipantIfNotCuffed();
-                child->inverter_used = false;
-            } else {
-                child->shotgun.shootBlankRound();
-            }
-            child->next_event.action = Action::Evaluating;
-            children.push_back(std::move(child));
+    void StateMachine::addPhoneMoves(const State& state, MoveList& moves){
+        const auto left_rounds = state.shotgun.getRemainingRounds();
+
+        // phone is useless for one round left
+        if(left_rounds < 2) {
+            moves.push_back(Move{});
+            return;
         }
-        probability = 1.0 - probability;
-        if(std::abs(probability) > parameters::EPSILON) {
-            // live round
-            auto child = std::make_unique<State>(parent);
-            child->probability = probability;
-            if(parent.inverter_used) {
-                child->shotgun.convertLiveRound();
-                child->shotgun.shootBlankRound();
-                child->inverter_used = false;
-            } else {
-                child->shotgun.shootLiveRound(child->getActiveParticipant());
-                child->switchParticipantIfNotCuffed();
+
+        // revealing a round whose type is already known or can be deduced from
+        // the round counts changes no decision, these outcomes are merged into
+        // a single child that does not record the revealed round
+        const bool is_player_turn = isPlayerTurn(state);
+        const double index_probability = 1.0/static_cast<double>(left_rounds - 1);
+        double known_probability{0.0};
+        for(unsigned int index = 1; index < left_rounds; ++index) {
+            if(state.shotgun.isRevealRedundant(index, is_player_turn)) {
+                known_probability += index_probability;
+                continue;
             }
-            child->next_event.action = Action::Evaluating;
-            children.push_back(std::move(child));
+            addRoundMoves(state, moves, index, index_probability);
+        }
+        if(known_probability > parameters::EPSILON) {
+            moves.push_back(Move{known_probability});
         }
-        assert(!children.empty());
-        return children;
     }
 
-    std::vector<std::unique_ptr<State>> StateMachine::getShootOtherChildStates(const State& parent){
-        std::vector<std::unique_ptr<State>> children{};
+    void StateMachine::applyDecision(State& state, const Move& move, const bool use_opponent_items){
+        // the order of commutative items restarts after any other event
+        const bool is_commutative = move.event.action == Action::UseItem && isCommutativeItem(move.event.item);
+        state.last_item = is_commutative ? move.event.item : Item::None;
+        state.next_event.action = move.event.action;
+        if(move.event.action != Action::UseItem) return;
+        state.next_event.item = move.event.item;
+        if(use_opponent_items) {
+            state.getOpponent().removeItem(move.event.item);
+        } else {
+            state.getActiveParticipant().removeItem(move.event.item);
+        }
+    }
 
-        double probability = parent.shotgun.getProbabilityOfBlankRound();
-        if(std::abs(probability) > parameters::EPSILON) {
-            // blank round
-            auto child = std::make_unique<State>(parent);
-            child->probability = probability;
-            if(parent.inverter_used) {
-                child->shotgun.convertBlankRound();
-                child->shotgun.shootLiveRound(child->getOpponent());
-                child->inverter_used = false;
+    void StateMachine::applyShootSelf(State& state, const Move& move){
+        state.probability = move.probability;
+        if(move.outcome == Outcome::BlankRound) {
+            if(state.inverter_used) {
+                state.shotgun.convertBlankRound();
+                state.shotgun.shootLiveRound(state.getActiveParticipant());
+                state.switchParticipantIfNotCuffed();
+                state.inverter_used = false;
             } else {
-                child->shotgun.shootBlankRound();
+                state.shotgun.shootBlankRound();
+            }
+        } else {
+            assert(move.outcome == Outcome::LiveRound);
+            if(state.inverter_used) {
+                state.shotgun.convertLiveRound();
+                state.shotgun.shootBlankRound();
+                state.inverter_used = false;
+            } else {
+                state.shotgun.shootLiveRound(state.getActiveParticipant());
+                state.switchParticipantIfNotCuffed();
             }
-            child->switchParticipantIfNotCuffed();
-            child->next_event.action = Action::Evaluating;
-            children.push_back(std::move(child));
         }
-        probability = 1.0 - probability;
-        if(std::abs(probability) > parameters::EPSILON) {
-            // live round
-            auto child = std::make_unique<State>(parent);
-            child->probability = probability;
-            if(parent.inverter_used) {
-                child->shotgun.convertLiveRound();
-                child->shotgun.shootBlankRound();
-                child->inverter_used = false;
+        state.next_event.action = Action::Evaluating;
+    }
+
+    void StateMachine::applyShootOther(State& state, const Move& move){
+        state.probability = move.probability;
+        if(move.outcome == Outcome::BlankRound) {
+            if(state.inverter_used) {
+                state.shotgun.convertBlankRound();
+                state.shotgun.shootLiveRound(state.getOpponent());
+                state.inverter_used = false;
             } else {
-                child->shotgun.shootLiveRound(child->getOpponent());
+                state.shotgun.shootBlankRound();
+            }
+        } else {
+            assert(move.outcome == Outcome::LiveRound);
+            if(state.inverter_used) {
+                state.shotgun.convertLiveRound();
+                state.shotgun.shootBlankRound();
+                state.inverter_used = false;
+            } else {
+                state.shotgun.shootLiveRound(state.getOpponent());
             }
-            child->switchParticipantIfNotCuffed();
-            child->next_event.action = Action::Evaluating;
-            children.push_back(std::move(child));
         }
-        assert(!children.empty());
-        return children;
+        state.switchParticipantIfNotCuffed();
+        state.next_event.action = Action::Evaluating;
     }
 
-    std::vector<std::unique_ptr<State>> StateMachine::getUseItemChildStates(const State& parent){
+    void StateMachine::applyUseItem(State& state, const Move& move){
         // decide by choice
-        switch (parent.next_event.item) {
+        switch (state.next_event.item) {
             case Item::Cigarette:
-                return getEvaluatingChildStates(*getCigaretteChildState(parent));
+                useCigarette(state);
+                return applyDecision(state, move);
             case Item::Glass:
-                return getGlassChildStates(parent);
+                return applyGainedRoundKnowledge(state, move);
             case Item::Saw:
-                return getEvaluatingChildStates(*getSawChildState(parent));
+                useSaw(state);
+                return applyDecision(state, move);
             case Item::Handcuffs:
-                return getEvaluatingChildStates(*getHandcuffsChildState(parent));
+                useHandcuffs(state);
+                return applyDecision(state, move);
             case Item::Phone:
-                return getPhoneChildStates(parent);
+                // phone is useless for one round left or revealed a known round
+                if(move.outcome == Outcome::None) {
+                    state.probability = move.probability;
+                    state.next_event.action = Action::Evaluating;
+                    return;
+                }
+                return applyGainedRoundKnowledge(state, move);
             case Item::Beer:
-                return getBeerChildStates(parent);
+                return applyBeer(state, move);
             case Item::Pills:
-                return getPillsChildStates(parent);
+                return applyPills(state, move);
             case Item::Inverter:
-                return getEvaluatingChildStates(*getInverterChildState(parent));
+                useInverter(state);
+                return applyDecision(state, move);
             case Item::Adrenalin:
-                return getAdrenalinChildStates(parent);
+                return applyDecision(state, move, true);
             default:
                 throw std::runtime_error("Unknown item type when trying to use an item");
         }
     }
 
-    std::vector<std::unique_ptr<State>> StateMachine::getGainedRoundKnowledgeChildStates(const State& parent, const unsigned int index){
-        std::vector<std::unique_ptr<State>> children{};
-
-        const bool is_player_turn = isPlayerTurn(parent);
-
-        double probability = parent.shotgun.getProbabilityOfBlankRound(index);
-        if(std::abs(probability) > parameters::EPSILON) {
-            // blank round
-            auto child = std::make_unique<State>(parent);
-            child->probability = probability;
-            if(!index && parent.inverter_used) {
-                child->shotgun.convertBlankRound();
-                child->inverter_used = false;
+    void StateMachine::applyGainedRoundKnowledge(State& state, const Move& move){
+        const unsigned int index = move.round_index;
+        state.probability = move.probability;
+        if(move.outcome == Outcome::BlankRound) {
+            if(!index && state.inverter_used) {
+                state.shotgun.convertBlankRound();
+                state.inverter_used = false;
             } else {
-                child->shotgun.setBlankRound(index);   
+                state.shotgun.setBlankRound(index);
             }
-            is_player_turn ? child->shotgun.makePlayerKnowRound(index) : child->shotgun.makeDealerKnowRound(index);
-            child->next_event.action = Action::Evaluating;
-            children.push_back(std::move(child));
-        }
-        probability = 1.0 - probability;
-        if(std::abs(probability) > parameters::EPSILON) {
-            // live round
-            auto child = std::make_unique<State>(parent);
-            child->probability = probability;
-            if(!index && parent.inverter_used) {
-                child->shotgun.convertLiveRound();
-                child->inverter_used = false;
+        } else {
+            assert(move.outcome == Outcome::LiveRound);
+            if(!index && state.inverter_used) {
+                state.shotgun.convertLiveRound();
+                state.inverter_used = false;
             } else {
-                child->shotgun.setLiveRound(index);
+                state.shotgun.setLiveRound(index);
             }
-            is_player_turn ? child->shotgun.makePlayerKnowRound(index) : child->shotgun.makeDealerKnowRound(index);
-            child->next_event.action = Action::Evaluating;
-            children.push_back(std::move(child));
         }
-        assert(!children.empty());
-        return children;
+        isPlayerTurn(state) ? state.shotgun.makePlayerKnowRound(index) : state.shotgun.makeDealerKnowRound(index);
+        state.next_event.action = Action::Evaluating;
     }
 
-    std::unique_ptr<State> StateMachine::getCigaretteChildState(const State& parent){
-        auto child = std::make_unique<State>(parent);
-        child->getActiveParticipant().gainLives(1, parent.max_lives);
-        child->next_event.action = Action::Evaluating;
-        return std::move(child);
-    }
-
-    std::vector<std::unique_ptr<State>> StateMachine::getGlassChildStates(const State& parent){
-        return getGainedRoundKnowledgeChildStates(parent, 0);
-    }
-
-   std::unique_ptr<State> StateMachine::getSawChildState(const State& parent){
-        auto child = std::make_unique<State>(parent);
-        child->shotgun.sawOff();
-        child->next_event.action = Action::Evaluating;
-        return std::move(child);
-    }
-
-    std::unique_ptr<State> StateMachine::getHandcuffsChildState(const State& parent){
-        auto child = std::make_unique<State>(parent);
-        child->handcuffs.add();
-        child->next_event.action = Action::Evaluating;
-        return std::move(child);
-    }
-
-    std::vector<std::unique_ptr<State>> StateMachine::getPhoneChildStates(const State& parent){
-        std::vector<std::unique_ptr<State>> children{};
-        const auto left_rounds = parent.shotgun.getRemainingRounds();
-
-        // phone is useless for one round left
-        if(left_rounds < 2) {
-            auto child = std::make_unique<State>(parent);
-            child->next_event.action = Action::Evaluating;
-            children.push_back(std::move(child));
-            assert(!children.empty());
-            return children;
-        }
-
-        for(unsigned int index = 1; index < left_rounds; ++index) {
-            auto new_children = getGainedRoundKnowledgeChildStates(parent, index);
-            for(auto& child : new_children) {
-                child->probability *= 1.0/static_cast<double>(left_rounds - 1);
-            }
-            children.insert(children.end(), std::make_move_iterator(new_children.begin()), std::make_move_iterator(new_children.end()));
-        }
-
-        assert(!children.empty());
-        return children;
-    }
-
-    std::vector<std::unique_ptr<State>> StateMachine::getBeerChildStates(const State& parent){
-        std::vector<std::unique_ptr<State>> children{};
-
-        double probability = parent.shotgun.getProbabilityOfBlankRound();
-        if(std::abs(probability) > parameters::EPSILON) {
-            // blank round
-            auto child = std::make_unique<State>(parent);
-            child->probability = probability;
-            if(parent.inverter_used) {
-                child->shotgun.convertBlankRound();
-                child->shotgun.ejectLiveRound();
-                child->inverter_used = false;
+    void StateMachine::applyBeer(State& state, const Move& move){
+        state.probability = move.probability;
+        if(move.outcome == Outcome::BlankRound) {
+            if(state.inverter_used) {
+                state.shotgun.convertBlankRound();
+                state.shotgun.ejectLiveRound();
+                state.inverter_used = false;
             } else {
-                child->shotgun.ejectBlankRound();
+                state.shotgun.ejectBlankRound();
             }
-            child->next_event.action = Action::Evaluating;
-            children.push_back(std::move(child));
-        }
-        probability = 1.0 - probability;
-        if(std::abs(probability) > parameters::EPSILON) {
-            // live round
-            auto child = std::make_unique<State>(parent);
-            child->probability = probability;
-            if(parent.inverter_used) {
-                child->shotgun.convertLiveRound();
-                child->shotgun.ejectBlankRound();
-                child->inverter_used = false;
+        } else {
+            assert(move.outcome == Outcome::LiveRound);
+            if(state.inverter_used) {
+                state.shotgun.convertLiveRound();
+                state.shotgun.ejectBlankRound();
+                state.inverter_used = false;
             } else {
-                child->shotgun.ejectLiveRound();
+                state.shotgun.ejectLiveRound();
             }
-            child->next_event.action = Action::Evaluating;
-            children.push_back(std::move(child));
         }
-        assert(!children.empty());
-        return children;
+        state.next_event.action = Action::Evaluating;
     }
 
-    std::vector<std::unique_ptr<State>> StateMachine::getPillsChildStates(const State& parent){
-        std::vector<std::unique_ptr<State>> children{};
-        {
-            // 50% chance to lose 1 health (unless max health is already reached)
-            auto child = std::make_unique<State>(parent);
-            child->probability = 0.5;
-            child->getActiveParticipant().loseLife();
-            child->next_event.action = Action::Evaluating;
-            children.push_back(std::move(child));
-        }
-        {
-            // 50% chance to gain 2 health (unless max health is already reached)
-            auto child = std::make_unique<State>(parent);
-            child->probability = 0.5;
-            child->getActiveParticipant().gainLives(2, parent.max_lives);
-            child->next_event.action = Action::Evaluating;
-            children.push_back(std::move(child));
+    void StateMachine::applyPills(State& state, const Move& move){
+        state.probability = move.probability;
+        if(move.outcome == Outcome::LoseLife) {
+            state.getActiveParticipant().loseLife();
+        } else {
+            assert(move.outcome == Outcome::GainLives);
+            state.getActiveParticipant().gainLives(2, state.max_lives);
         }
-        assert(!children.empty());
-        return children;
+        state.next_event.action = Action::Evaluating;
+    }
+
+    void StateMachine::useCigarette(State& state){
+        state.getActiveParticipant().gainLives(1, state.max_lives);
+        state.next_event.action = Action::Evaluating;
+    }
+
+    void StateMachine::useSaw(State& state){
+        state.shotgun.sawOff();
+        state.next_event.action = Action::Evaluating;
     }
 
-    std::unique_ptr<State> StateMachine::getInverterChildState(const State& parent){
-        auto child = std::make_unique<State>(parent);
-        child->inverter_used = true;
-        child->next_event.action = Action::Evaluating;
-        return std::move(child);
+    void StateMachine::useHandcuffs(State& state){
+        state.handcuffs.add();
+        state.next_event.action = Action::Evaluating;
     }
 
-    std::vector<std::unique_ptr<State>> StateMachine::getAdrenalinChildStates(const State& parent) {
-        return getEvaluatingChildStates(parent, true);
+    void StateMachine::useInverter(State& state){
+        state.inverter_used = true;
+        state.next_event.action = Action::Evaluating;
     }
 
     double StateMachine::getProbabilityOfBlankRound(const State& state, const bool inverter_used, const unsigned int index) {
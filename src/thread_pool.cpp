@@ -0,0 +1,110 @@
+#include "search/thread_pool.hpp"
+#include <algorithm>
+
+namespace search{
+
+    namespace {
+        // pool and queue of the calling thread
+        struct ThreadSlot{
+            const ThreadPool* pool{nullptr};
+            std::size_t index{0};
+        };
+
+        thread_local ThreadSlot current_thread;
+    }
+
+    ThreadPool::ThreadPool(const std::size_t thread_count)
+        : thread_count(std::max<std::size_t>(thread_count, 1)), queues(std::make_unique<Queue[]>(this->thread_count)) {
+        // the thread that uses the pool works on queue 0 while it waits
+        threads.reserve(this->thread_count - 1);
+        for(std::size_t index = 1; index < this->thread_count; ++index) {
+            threads.emplace_back([this, index]() { work(index); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        wake_up.notify_all();
+        for(auto& thread : threads) thread.join();
+    }
+
+    std::size_t ThreadPool::getThreadIndex() const {
+        return current_thread.pool == this ? current_thread.index : 0;
+    }
+
+    void ThreadPool::push(const Task& task) {
+        Queue& queue = queues[getThreadIndex()];
+        bool is_queued{false};
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if(queue.tasks.size() < queue.tasks.capacity()) {
+                queue.tasks.push_back(task);
+                queued_tasks.fetch_add(1);
+                is_queued = true;
+            }
+        }
+        if(!is_queued) {
+            // a full queue has enough work for everyone
+            execute(task);
+            return;
+        }
+        // a sleeping thread checks for tasks while it holds the mutex, so the notification cannot get lost
+        { std::lock_guard<std::mutex> lock(sleep_mutex); }
+        wake_up.notify_one();
+    }
+
+    bool ThreadPool::runNext() {
+        const std::size_t index = getThreadIndex();
+        Task task;
+        {
+            Queue& queue = queues[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if(!queue.tasks.empty()) {
+                task = queue.tasks.back();
+                queue.tasks.pop_back();
+            }
+        }
+        for(std::size_t offset = 1; !task.function && offset < thread_count; ++offset) {
+            Queue& victim = queues[(index + offset) % thread_count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if(!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+            }
+        }
+        if(!task.function) return false;
+        queued_tasks.fetch_sub(1);
+        execute(task);
+        return true;
+    }
+
+    void ThreadPool::work(const std::size_t index) {
+        current_thread = {this, index};
+        while(true) {
+            if(runNext()) continue;
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            wake_up.wait(lock, [this]() { return stopping || queued_tasks.load(); });
+            if(stopping) return;
+        }
+    }
+
+    void ThreadPool::execute(const Task& task) {
+        try {
+            task.function(task.context, task.index);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(task.group->exception_mutex);
+            if(!task.group->exception) task.group->exception = std::current_exception();
+        }
+        task.group->pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    void ThreadPool::TaskGroup::wait() {
+        while(pending.load(std::memory_order_acquire)) {
+            if(!pool.runNext()) std::this_thread::yield();
+        }
+        if(exception) std::rethrow_exception(exception);
+    }
+}
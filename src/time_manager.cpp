@@ -0,0 +1,57 @@
+#include "search/time_manager.hpp"
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+
+namespace search{
+
+    namespace {
+        using Clock = CancellationToken::Clock;
+
+        Clock::time_point getDeadline(const Clock::time_point start, const double seconds) {
+            // limits of more than a year count as no limit and must not overflow the clock
+            return start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(std::min(seconds, 3.2e7)));
+        }
+    }
+
+    TimeManager::TimeManager(CancellationToken& token, const SearchLimits& limits) : token(token) {
+        const auto start = Clock::now();
+        const auto deadline = getDeadline(start, limits.time_limit);
+        token.visited_nodes.store(0, std::memory_order_relaxed);
+        token.node_limit = limits.node_limit;
+        token.soft_deadline = std::min(getDeadline(start, limits.soft_time_limit), deadline);
+        token.hard_deadline = deadline;
+        thread = std::thread([this, start, deadline]() {
+            std::unique_lock<std::mutex> lock(mutex);
+            if(wake_up.wait_until(lock, deadline, [this]() { return finished || stopped; })) {
+                if(finished) return;
+            } else {
+                const std::chrono::duration<double> elapsed = Clock::now() - start;
+                std::cout << "Aborting search after execution time of " << elapsed.count() << " seconds surpassed the time limit. Waiting for result.\n";
+            }
+            this->token.expired.store(true, std::memory_order_relaxed);
+        });
+    }
+
+    TimeManager::~TimeManager() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+        }
+        wake_up.notify_all();
+        thread.join();
+        // the limits only hold for this search, an explicit cancellation stays
+        token.expired.store(false, std::memory_order_relaxed);
+        token.node_limit = 0;
+        token.soft_deadline = Clock::time_point::max();
+        token.hard_deadline = Clock::time_point::max();
+    }
+
+    void TimeManager::stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+        }
+        wake_up.notify_all();
+    }
+}
@@ -3,24 +3,77 @@
 #include <catch2/catch_session.hpp>
 #include "engine/state_machine.hpp"
 #include "engine/evaluator.hpp"
+#include "engine/endgame_table.hpp"
 #include "search/threaded_search.hpp"
+#include "search/lazy_smp_search.hpp"
 #include "search/iterative_search.hpp"
 #include "search/transposition_search.hpp"
 #include "search/search.hpp"
+#include "search/make_unmake_search.hpp"
 #include "string_functions.hpp"
 #include <iostream>
 #include <chrono>
+#include <random>
+#include <vector>
+#include <thread>
 
 using Evaluator = engine::Evaluator;
 using StateMachine = engine::StateMachine;
 using Solver = search::ThreadedSearch<search::TranspositionSearch<StateMachine, Evaluator>>;
 
-#define SOLVER_TYPES (search::ThreadedSearch<search::TranspositionSearch<StateMachine, Evaluator>>), (search::ExtendedSearch<search::TranspositionSearch<StateMachine, Evaluator>>), (search::ThreadedSearch<search::Search<StateMachine, Evaluator>>), (search::ExtendedSearch<search::Search<StateMachine, Evaluator>>), (search::ExtendedSearch<search::IterativeSearch<search::TranspositionSearch<StateMachine, Evaluator>>>)
+#define SOLVER_TYPES (search::ThreadedSearch<search::TranspositionSearch<StateMachine, Evaluator>>), (search::ExtendedSearch<search::TranspositionSearch<StateMachine, Evaluator>>), (search::ThreadedSearch<search::Search<StateMachine, Evaluator>>), (search::ExtendedSearch<search::Search<StateMachine, Evaluator>>), (search::ExtendedSearch<search::IterativeSearch<search::TranspositionSearch<StateMachine, Evaluator>>>), (search::ExtendedSearch<search::MakeUnmakeSearch<StateMachine, Evaluator>>), (search::LazySmpSearch<search::TranspositionSearch<StateMachine, Evaluator>>), (search::ExtendedSearch<search::Search<StateMachine, Evaluator, search::MoveOrdering<>, search::ChancePruning::Star1, true>>), (search::ExtendedSearch<search::IterativeSearch<search::TranspositionSearch<StateMachine, Evaluator, search::MoveOrdering<>, search::ChancePruning::Star1, true>, true>>)
 #define DEBUG_TYPE (search::ExtendedSearch<search::Search<StateMachine, Evaluator>>)
 
 namespace {
     constexpr unsigned int max_shallow_depth = parameters::MAX_SHALLOW_DEPTH;
     constexpr unsigned int max_deep_depth = 48; // maximum possible
+
+    // the scores of the evaluator without its endgame table, so searches have to reach the end of the stage
+    struct SearchedEvaluator {
+        static double getScore(const engine::State& state) { return Evaluator::getScore(state); }
+        static constexpr double MIN_SCORE{Evaluator::MIN_SCORE};
+        static constexpr double MAX_SCORE{Evaluator::MAX_SCORE};
+    };
+
+    // expectiminimax without any pruning as a reference, solved states end the search like in the searches
+    double getUnprunedScore(const engine::State& parent, const unsigned int depth) {
+        if(const auto score = Evaluator::getExactScore(parent)) return *score;
+        if(StateMachine::isFinished(parent) || !depth) return Evaluator::getScore(parent);
+        const auto children = StateMachine::getChildStates(parent);
+        if(children.size() == 1) return getUnprunedScore(*children.front(), depth);
+        if(StateMachine::isEvaluationPhase(parent.next_event)) {
+            const bool is_player_turn = StateMachine::isPlayerTurn(parent);
+            double score = is_player_turn ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+            for(const auto& child : children) {
+                const double result = getUnprunedScore(*child, depth - 1);
+                score = is_player_turn ? std::max(score, result) : std::min(score, result);
+            }
+            return score;
+        }
+        double score = 0.0;
+        for(const auto& child : children) score += child->probability * getUnprunedScore(*child, depth - 1);
+        return score;
+    }
+
+    std::vector<engine::State> getRandomPositions(const std::size_t count, const unsigned int items_per_participant = 3) {
+        constexpr engine::Item items[] = {engine::Item::Beer, engine::Item::Glass, engine::Item::Phone, engine::Item::Saw,
+                                          engine::Item::Inverter, engine::Item::Pills, engine::Item::Cigarette, engine::Item::Handcuffs};
+        std::mt19937 generator{1};
+        std::vector<engine::State> positions;
+        for(std::size_t index = 0; index < count; ++index) {
+            engine::State state{};
+            const unsigned int live_rounds = 1 + generator() % 3;
+            state.shotgun.load(live_rounds, 1 + generator() % 3);
+            state.resetLives(2 + generator() % 3);
+            for(unsigned int item = 0; item < items_per_participant; ++item) {
+                state.player.items.add(items[generator() % 8]);
+                state.dealer.items.add(items[generator() % 8]);
+            }
+            state.refreshKey();
+            positions.push_back(state);
+        }
+        return positions;
+    }
 }
 
 template <typename Solver>
@@ -369,6 +422,189 @@ TEMPLATE_TEST_CASE_METHOD(TestFixture, "4 rounds case", "[search][template][play
     this->run();
 }
 
+TEST_CASE("Pruned search matches unpruned expectiminimax", "[search]") {
+    // outcomes of a random event may only be cut once they cannot move the expected score back into the window
+    std::size_t mismatches{0};
+    // positions with few items soon reach solved endgames
+    auto positions = getRandomPositions(100);
+    for(const auto& state : getRandomPositions(100, 1)) positions.push_back(state);
+    for(const auto& state : positions) {
+        search::Search<StateMachine, Evaluator> solver;
+        search::Search<StateMachine, Evaluator, search::MoveOrdering<>, search::ChancePruning::Star2> probing_solver;
+        const double expected = getUnprunedScore(state, 4);
+        if(std::abs(solver.expectiminimax(state, 4) - expected) > parameters::EPSILON) ++mismatches;
+        if(std::abs(probing_solver.expectiminimax(state, 4) - expected) > parameters::EPSILON) ++mismatches;
+    }
+    REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("Transposition bounds match plain search", "[search][transposition]") {
+    std::size_t mismatches{0}, search_nodes{0}, transposition_nodes{0};
+    // deep enough to reach the end of every line, so results of any depth are exact
+    for(const auto& state : getRandomPositions(30, 2)) {
+        search::Search<StateMachine, Evaluator> plain_solver;
+        search::TranspositionSearch<StateMachine, Evaluator> transposition_solver;
+        search::IterativeSearch<search::TranspositionSearch<StateMachine, Evaluator>> iterative_solver;
+        const double expected = plain_solver.expectiminimax(state, max_deep_depth);
+        if(std::abs(expected - transposition_solver.expectiminimax(state, max_deep_depth)) > parameters::EPSILON) ++mismatches;
+        // iterative deepening reuses bounds of shallower passes
+        if(std::abs(expected - iterative_solver.expectiminimax(state, max_deep_depth)) > parameters::EPSILON) ++mismatches;
+        search_nodes += plain_solver.node_count;
+        transposition_nodes += transposition_solver.node_count;
+    }
+    std::cout << "Plain search: " << search_nodes << " nodes, transposition search: " << transposition_nodes << " nodes.\n";
+    REQUIRE(mismatches == 0);
+    REQUIRE(transposition_nodes < search_nodes);
+}
+
+TEST_CASE("Threaded iterative search keeps deep results of the running search", "[search][transposition]") {
+    const engine::State state = getRandomPositions(1, 4).front();
+    // a table with a single bucket, every result of the search competes with the deep one
+    search::ThreadedSearch<search::IterativeSearch<search::TranspositionSearch<StateMachine, Evaluator>>> solver{std::size_t{0}};
+    const auto table = solver.getSharedTable();
+    REQUIRE(table->getBucketCount() == 1);
+    // the first leaf of the search looks at the deep result first and makes it a result of the running search
+    const auto children = StateMachine::getChildStates(state);
+    const std::uint64_t key = children.front()->key;
+    table->store(key, Evaluator::getScore(*children.front()), 1000);
+    solver.expectiminimax(state, 1, 4);
+    // the leaves do not age the table, shallower results of later leaves may not evict the deep one
+    REQUIRE(table->probe(key, 1000));
+}
+
+TEST_CASE("Iterative deepening stops once the result is known", "[search][iterative]") {
+    std::size_t too_deep{0}, unstable{0}, stable_leaves{0};
+    for(const auto& state : getRandomPositions(30, 2)) {
+        search::IterativeSearch<search::TranspositionSearch<StateMachine, Evaluator>> iterative_solver;
+        search::IterativeSearch<search::TranspositionSearch<StateMachine, Evaluator>, false, true> stable_solver;
+        iterative_solver.expectiminimax(state, max_deep_depth);
+        stable_solver.expectiminimax(state, max_deep_depth);
+        // iterations deeper than the longest line repeat the last one
+        if(iterative_solver.completed_depth > StateMachine::getMaxDepth(state)) ++too_deep;
+        if(stable_solver.completed_depth > iterative_solver.completed_depth) ++unstable;
+        // the leaves only get windows and do not stop when their bounds seem stable
+        search::ExtendedSearch<search::IterativeSearch<search::TranspositionSearch<StateMachine, Evaluator>>> leaf_solver;
+        search::ExtendedSearch<search::IterativeSearch<search::TranspositionSearch<StateMachine, Evaluator>, false, true>> stable_leaf_solver;
+        leaf_solver.expectiminimax(state, max_shallow_depth, max_deep_depth);
+        stable_leaf_solver.expectiminimax(state, max_shallow_depth, max_deep_depth);
+        if(stable_leaf_solver.node_count != leaf_solver.node_count) ++stable_leaves;
+    }
+    REQUIRE(too_deep == 0);
+    REQUIRE(unstable == 0);
+    REQUIRE(stable_leaves == 0);
+}
+
+TEST_CASE("Iterative deepening around a threaded search", "[search][iterative]") {
+    std::size_t mismatches{0}, unstable{0};
+    for(const auto& state : getRandomPositions(10, 2)) {
+        const auto expected = search::ThreadedSearch<search::TranspositionSearch<StateMachine, Evaluator>>{}.expectiminimax(state, max_shallow_depth, 6);
+        search::IterativeSearch<search::ThreadedSearch<search::TranspositionSearch<StateMachine, Evaluator>>> iterative_solver;
+        search::IterativeSearch<search::ThreadedSearch<search::TranspositionSearch<StateMachine, Evaluator>>, false, true> stable_solver;
+        // the last iteration searches the shallow and the deep part completely
+        if(iterative_solver.expectiminimax(state, max_shallow_depth, 6) != expected) ++mismatches;
+        stable_solver.expectiminimax(state, max_shallow_depth, 6);
+        if(stable_solver.completed_depth > iterative_solver.completed_depth) ++unstable;
+    }
+    REQUIRE(mismatches == 0);
+    REQUIRE(unstable == 0);
+}
+
+TEST_CASE("Endgame table matches a full search", "[search][endgame]") {
+    std::size_t mismatches{0}, covered{0};
+    std::mt19937 generator{1};
+    for(std::size_t index = 0; index < 200; ++index) {
+        engine::State state{};
+        const unsigned int rounds = 1 + generator() % game_parameters::MAX_SHELLS;
+        const unsigned int live_rounds = generator() % (rounds + 1);
+        state.shotgun.load(live_rounds, rounds - live_rounds);
+        state.resetLives(game_parameters::MAX_LIVES);
+        state.player.lives = 1 + generator() % game_parameters::MAX_LIVES;
+        state.dealer.lives = 1 + generator() % game_parameters::MAX_LIVES;
+        state.next_event.is_player_turn = generator() % 2;
+        if(generator() % 2) state.shotgun.sawOff();
+        if(generator() % 3) state.handcuffs.add();
+        if(generator() % 2) state.handcuffs.decay();
+        state.refreshKey();
+        const auto exact = engine::EndgameTable::probe(state);
+        if(!exact) continue;
+        ++covered;
+        const double expected = search::Search<StateMachine, SearchedEvaluator>{}.expectiminimax(state, max_deep_depth);
+        if(std::abs(*exact - expected) > parameters::EPSILON) ++mismatches;
+    }
+    REQUIRE(covered == 200);
+    REQUIRE(mismatches == 0);
+
+    // revealed rounds may still change the decisions
+    engine::State state{};
+    state.shotgun.load(2, 2);
+    state.resetLives(2);
+    state.shotgun.setLiveRound(1);
+    state.shotgun.makePlayerKnowRound(1);
+    state.refreshKey();
+    REQUIRE_FALSE(engine::EndgameTable::probe(state));
+    state.player.items.add(engine::Item::Beer);
+    REQUIRE_FALSE(engine::EndgameTable::probe(state));
+}
+
+TEST_CASE("Cancelled searches do not stop other searches", "[search][cancellation]") {
+    const engine::State state = getRandomPositions(1, 4).front();
+    search::Search<StateMachine, Evaluator> cancelled_solver;
+    cancelled_solver.getCancellation()->cancel();
+    // the token is polled every few nodes, the search must be large enough to look at it
+    REQUIRE(search::isAborted(cancelled_solver.expectiminimax(state, max_deep_depth)));
+
+    // a search that runs out of time while another one runs
+    const auto expected = search::ExtendedSearch<search::TranspositionSearch<StateMachine, Evaluator>>{}.expectiminimax(state, max_shallow_depth, 6);
+    std::thread timed_out_search([&state]() {
+        Solver timed_out_solver;
+        timed_out_solver.expectiminimax(state, max_shallow_depth, 6, 0.0);
+    });
+    Solver solver;
+    const auto result = solver.expectiminimax(state, max_shallow_depth, 6);
+    timed_out_search.join();
+    REQUIRE(result == expected);
+
+    // the time limit only holds for a single call
+    search::ThreadedSearch<search::IterativeSearch<search::TranspositionSearch<StateMachine, Evaluator>>> iterative_solver;
+    iterative_solver.expectiminimax(state, max_shallow_depth, 6, 0.0);
+    REQUIRE_FALSE(iterative_solver.getCancellation()->isCancelled());
+}
+
+TEST_CASE("Node limits stop searches reproducibly", "[search][cancellation]") {
+    const engine::State state = getRandomPositions(1, 4).front();
+    constexpr std::size_t node_limit{50000};
+    const search::SearchLimits limits{std::numeric_limits<double>::infinity(), node_limit};
+    using IterativeSolver = search::ThreadedSearch<search::IterativeSearch<search::TranspositionSearch<StateMachine, Evaluator>>>;
+    IterativeSolver first_solver;
+    IterativeSolver second_solver;
+    const auto first = first_solver.expectiminimax(state, max_shallow_depth, max_deep_depth, limits);
+    const auto second = second_solver.expectiminimax(state, max_shallow_depth, max_deep_depth, limits);
+    REQUIRE_FALSE(search::isAborted(first.score));
+    REQUIRE(first == second);
+    REQUIRE(first_solver.node_count == second_solver.node_count);
+    // the node limit is checked whenever the token is polled
+    REQUIRE(first_solver.node_count <= node_limit + parameters::CANCELLATION_CHECK_INTERVAL);
+    REQUIRE_FALSE(first_solver.getCancellation()->isCancelled());
+}
+
+TEST_CASE("Soft deadline only ends iterations at the root", "[search][cancellation]") {
+    const engine::State state = getRandomPositions(1, 4).front();
+    search::SearchLimits limits{std::numeric_limits<double>::infinity()};
+    limits.soft_time_limit = 0.0;
+    // the iterative searches at the leaves finish their depth although the soft deadline has passed
+    const auto expected = search::ThreadedSearch<search::TranspositionSearch<StateMachine, Evaluator>>{}.expectiminimax(state, max_shallow_depth, 6);
+    const auto result = search::ThreadedSearch<search::IterativeSearch<search::TranspositionSearch<StateMachine, Evaluator>>>{}.expectiminimax(state, max_shallow_depth, 6, limits);
+    REQUIRE(std::abs(result.score - expected.score) < parameters::EPSILON);
+
+    // at the root no iteration starts after the soft deadline
+    search::IterativeSearch<search::TranspositionSearch<StateMachine, Evaluator>> iterative_solver;
+    {
+        search::TimeManager time_manager{*iterative_solver.getCancellation(), limits};
+        iterative_solver.expectiminimax(state, max_deep_depth);
+    }
+    REQUIRE(iterative_solver.completed_depth == 1);
+}
+
 int main(int argc, char* argv[]) {
     Catch::Session session;
 
@@ -304,6 +304,17 @@ TEST_CASE_METHOD(TestFixture, "Dealer shoots player with saw", "[game][dealer]")
     requireResult(game, LOSS);
 }
 
+TEST_CASE_METHOD(TestFixture, "Dealer shoots self after sawing off a blank round", "[game][dealer]") {
+    item_drawer->dealer_items = {engine::Item::Saw, engine::Item::Glass};
+    player->choices = {{true, Action::ShootOther}};
+    // the glass shows a blank round after the shotgun was sawed off, the saw is wasted
+    dealer->choices = {{false, Action::UseItem, Item::Saw}, {false, Action::UseItem, Item::Glass}, {false, Action::ShootSelf}, {false, Action::ShootOther}};
+    randomizer->choices = {0,0};
+    auto game = getGame();
+    game.start(2,2,1);
+    requireResult(game, LOSS);
+}
+
 TEST_CASE_METHOD(TestFixture, "Hidden outcome(Glass) + Glass", "[game][dealer][hidden]") {
     randomizer = std::make_unique<FakeHiddenRandomizer>();
     item_drawer->dealer_items = {engine::Item::Glass, engine::Item::Glass};
@@ -3,10 +3,60 @@
 #include "engine/state_machine.hpp"
 #include "engine/evaluator.hpp"
 #include "search/threaded_search.hpp"
+#include "search/transposition_table.hpp"
 #include "string_functions.hpp"
 #include <iostream>
 #include <chrono>
 #include <bitset>
+#include <algorithm>
+#include <deque>
+#include <unordered_set>
+#include <thread>
+#include <atomic>
+
+namespace {
+    // hash of the state before zobrist keys were introduced
+    std::size_t getLegacyHash(const engine::State& state) {
+        const auto [h1, l1] = state.player.getHash(8);
+        const auto [h2, l2] = state.dealer.getHash(8);
+        const auto [h3, l3] = state.shotgun.getHash(8);
+        const auto [h4, l4] = state.handcuffs.getHash();
+        const auto [h5, l5] = state.next_event.getHash();
+
+        std::size_t hash = h1.to_ulong() ^ h2.to_ulong();
+        hash = hash << l3 | h3.to_ulong();
+        hash = hash << l4 | h4.to_ulong();
+        hash = hash << l5 | h5.to_ulong();
+        hash = hash << 1 | (state.max_lives % 2);
+        hash = hash << 1 | state.inverter_used;
+        return hash;
+    }
+
+    // collects distinct states breadth first
+    std::unordered_set<engine::State> getReachableStates(const engine::State& root, const std::size_t max_states) {
+        std::unordered_set<engine::State> states{root};
+        std::deque<engine::State> queue{root};
+        while(!queue.empty() && states.size() < max_states) {
+            const auto parent = queue.front();
+            queue.pop_front();
+            if(engine::StateMachine::isFinished(parent)) continue;
+            for(auto& child : engine::StateMachine::getChildStates(parent)) {
+                if(states.insert(*child).second) queue.push_back(*child);
+            }
+        }
+        return states;
+    }
+
+    engine::State getStartState() {
+        engine::State state{};
+        state.resetLives(4);
+        state.shotgun.load(4, 4);
+        state.player.items = {engine::Item::Glass, engine::Item::Phone, engine::Item::Beer, engine::Item::Inverter};
+        state.dealer.items = {engine::Item::Cigarette, engine::Item::Saw, engine::Item::Handcuffs, engine::Item::Pills};
+        state.refreshKey();
+        return state;
+    }
+}
 
 TEST_CASE("Participant hash test", "[Participant]") {
     engine::Participant participant;
@@ -15,7 +65,20 @@ TEST_CASE("Participant hash test", "[Participant]") {
     auto [hash, length] = participant.getHash(8);
 
     REQUIRE(hash.to_ulong() == 0b110000);
-    REQUIRE(length == 6);
+    REQUIRE(length == 32);
+}
+
+TEST_CASE("Participant item hash test", "[Participant]") {
+    engine::Participant participant;
+    participant.lives = 3;
+    participant.items = {engine::Item::Cigarette, engine::Item::Glass};
+    engine::Participant other_participant;
+    other_participant.lives = 3;
+    other_participant.items = {engine::Item::Saw};
+
+    // item ids 1 ^ 2 == 3 used to collide
+    REQUIRE(participant.getHash(8).first != other_participant.getHash(8).first);
+    REQUIRE_FALSE(participant == other_participant);
 }
 
 TEST_CASE("Event hash test", "[Event]") {
@@ -47,6 +110,195 @@ TEST_CASE("Participant hash test", "[Shotgun]") {
     REQUIRE(length == 9);
 }
 
+TEST_CASE("Incremental zobrist key test", "[State]") {
+    REQUIRE(engine::State{}.computeKey() == 0);
+
+    const auto states = getReachableStates(getStartState(), 100000);
+    std::size_t stale_keys{0};
+    for(const auto& state : states) {
+        if(state.key != state.computeKey()) ++stale_keys;
+    }
+    REQUIRE(stale_keys == 0);
+}
+
+TEST_CASE("Apply and undo test", "[State]") {
+    const auto states = getReachableStates(getStartState(), 20000);
+    std::size_t mismatches{0};
+    for(const auto& parent : states) {
+        if(engine::StateMachine::isFinished(parent)) continue;
+        engine::MoveList moves;
+        engine::StateMachine::generateMoves(parent, moves);
+        auto state = parent;
+        for(const auto& move : moves) {
+            const auto record = engine::StateMachine::apply(state, move);
+            if(state.key != state.computeKey()) ++mismatches;
+            engine::StateMachine::undo(state, record);
+            if(!(state == parent) || state.key != parent.key) ++mismatches;
+        }
+    }
+    REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("Child predicate test", "[State]") {
+    auto root = getStartState();
+    root.player.items.add(engine::Item::Adrenalin);
+    root.refreshKey();
+    const auto states = getReachableStates(root, 20000);
+    std::size_t mismatches{0};
+    for(const auto& parent : states) {
+        if(engine::StateMachine::isFinished(parent)) continue;
+        const auto children = engine::StateMachine::getChildStates(parent);
+        if(engine::StateMachine::countChildren(parent) != children.size()) ++mismatches;
+        if(engine::StateMachine::isForcedMove(parent) != (children.size() == 1)) ++mismatches;
+        if(parent.next_event.action != engine::Action::Evaluating) continue;
+        if(!parent.getActiveParticipant().items.contains(engine::Item::Adrenalin)) continue;
+        // adrenalin is only offered when an item can be stolen
+        const bool offers_adrenalin = std::any_of(children.begin(), children.end(), [](const auto& child) {
+            return child->next_event.action == engine::Action::UseItem && child->next_event.item == engine::Item::Adrenalin;
+        });
+        if(engine::StateMachine::hasUsableOpponentItem(parent) != offers_adrenalin) ++mismatches;
+    }
+    REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("Child generator priority test", "[State]") {
+    const auto states = getReachableStates(getStartState(), 2000);
+    std::size_t mismatches{0};
+    for(const auto& parent : states) {
+        if(engine::StateMachine::isFinished(parent)) continue;
+        const auto children = engine::StateMachine::getChildStates(parent);
+        const std::size_t prioritized = children.size() / 2;
+        engine::StateMachine::ChildGenerator generator{parent};
+        generator.prioritize(prioritized);
+        std::vector<bool> created(children.size(), false);
+        while(generator.hasNext()) {
+            const auto child = generator.next();
+            const std::size_t move_index = generator.getMoveIndex();
+            if(generator.remaining() + 1 == children.size() && move_index != prioritized) ++mismatches;
+            if(created[move_index] || !(child == *children[move_index])) ++mismatches;
+            created[move_index] = true;
+        }
+        if(std::count(created.begin(), created.end(), true) != static_cast<long>(children.size())) ++mismatches;
+    }
+    REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("Redundant phone reveal test", "[State]") {
+    engine::State state{};
+    state.resetLives(2);
+    state.shotgun.load(3, 1);
+    // the glass showed the only blank round, all other rounds must be live
+    state.shotgun.setBlankRound(0);
+    state.shotgun.makePlayerKnowRound(0);
+    state.next_event = {true, engine::Action::UseItem, engine::Item::Phone};
+    state.refreshKey();
+
+    const auto children = engine::StateMachine::getChildStates(state);
+    REQUIRE(children.size() == 1);
+    REQUIRE(children.front()->probability == 1.0);
+    REQUIRE(children.front()->shotgun == state.shotgun);
+}
+
+TEST_CASE("Commutative item order test", "[State]") {
+    engine::State state{};
+    state.resetLives(2);
+    state.shotgun.load(2, 2);
+    state.player.items = {engine::Item::Cigarette, engine::Item::Saw};
+    state.refreshKey();
+
+    const auto offersItem = [](const engine::State& parent, const engine::Item item) {
+        for(const auto& child : engine::StateMachine::getChildStates(parent)) {
+            if(child->next_event.action == engine::Action::UseItem && child->next_event.item == item) return true;
+        }
+        return false;
+    };
+    const auto useItem = [](const engine::State& parent, const engine::Item item) {
+        for(auto& child : engine::StateMachine::getChildStates(parent)) {
+            if(child->next_event.action == engine::Action::UseItem && child->next_event.item == item) return *child;
+        }
+        FAIL("item is not offered");
+        return parent;
+    };
+
+    // saw after cigarette is the only order that is searched
+    REQUIRE(offersItem(useItem(state, engine::Item::Cigarette), engine::Item::Saw));
+    REQUIRE_FALSE(offersItem(useItem(state, engine::Item::Saw), engine::Item::Cigarette));
+}
+
+TEST_CASE("Transposition table replacement test", "[TranspositionTable]") {
+    search::TranspositionTable table{1};
+    const std::uint64_t key = 5;
+    const std::uint64_t same_bucket_key = key + table.getBucketCount();
+    const std::uint64_t third_key = key + 2 * table.getBucketCount();
+
+    table.store(key, 1.0, 4);
+    REQUIRE(table.probe(key, 4).value().score == 1.0);
+    REQUIRE_FALSE(table.probe(key, 5));
+
+    // shallower results may not evict the deep one
+    REQUIRE_FALSE(table.store(same_bucket_key, 2.0, 2));
+    REQUIRE(table.store(third_key, 3.0, 1));
+    REQUIRE(table.probe(key, 4).value().score == 1.0);
+    REQUIRE_FALSE(table.probe(same_bucket_key, 2));
+    REQUIRE(table.probe(third_key, 1).value().score == 3.0);
+
+    // results of an older search age out
+    table.newSearch();
+    REQUIRE(table.store(same_bucket_key, 2.0, 2));
+    REQUIRE(table.probe(same_bucket_key, 2).value().score == 2.0);
+    REQUIRE(table.probe(key, 4).value().score == 1.0);
+
+    REQUIRE(table.getFill() == 2.0 / (2 * std::min<std::size_t>(table.getBucketCount(), 1024)));
+
+    // bounds and moves survive the packing into a slot
+    table.store(third_key, 4.0, 6, search::TranspositionTable::Bound::Upper, 15);
+    REQUIRE(table.probe(third_key, 6).value().bound == search::TranspositionTable::Bound::Upper);
+    REQUIRE(table.probe(third_key, 6).value().best_move == 15);
+    // a result without a move keeps the known one
+    table.store(third_key, 4.0, 7, search::TranspositionTable::Bound::Upper);
+    REQUIRE(table.probe(third_key, 7).value().best_move == 15);
+    REQUIRE(table.probe(same_bucket_key, 2).value().best_move == search::TranspositionTable::NO_MOVE);
+}
+
+TEST_CASE("Shared transposition table test", "[TranspositionTable]") {
+    // a tiny table forces the threads to overwrite each other's slots
+    search::TranspositionTable table{0};
+    std::atomic<std::size_t> wrong_scores{0};
+    std::vector<std::thread> threads;
+    for(std::uint64_t thread = 0; thread < 4; ++thread) {
+        threads.emplace_back([&table, &wrong_scores, thread]() {
+            for(std::uint64_t index = 0; index < 200000; ++index) {
+                const std::uint64_t key = (index * 4 + thread) * 0x9E3779B97F4A7C15ull;
+                table.store(key, static_cast<double>(key % 1000), key % 7);
+                const std::uint64_t other_key = ((index + 1) * 4 + (thread + 1) % 4) * 0x9E3779B97F4A7C15ull;
+                const auto entry = table.probe(other_key, 0);
+                if(entry && entry->score != static_cast<double>(other_key % 1000)) ++wrong_scores;
+            }
+        });
+    }
+    for(auto& thread : threads) thread.join();
+    REQUIRE(wrong_scores == 0);
+}
+
+TEST_CASE("State hash collision report", "[State]") {
+    const auto states = getReachableStates(getStartState(), 200000);
+
+    std::unordered_set<std::size_t> legacy_hashes, keys;
+    for(const auto& state : states) {
+        legacy_hashes.insert(getLegacyHash(state));
+        keys.insert(std::hash<engine::State>{}(state));
+    }
+
+    const auto getCollisionRate = [&states](const std::size_t distinct_hashes) {
+        return 1.0 - distinct_hashes / static_cast<double>(states.size());
+    };
+    std::cout << "Distinct states: " << states.size() << ".\n";
+    std::cout << "Legacy hash: " << legacy_hashes.size() << " distinct values, collision rate " << getCollisionRate(legacy_hashes.size()) << ".\n";
+    std::cout << "Zobrist key: " << keys.size() << " distinct values, collision rate " << getCollisionRate(keys.size()) << ".\n";
+
+    REQUIRE(keys.size() == states.size());
+}
+
 int main(int argc, char* argv[]) {
     Catch::Session session;
 
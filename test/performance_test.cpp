@@ -1,38 +1,86 @@
 #include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_session.hpp>
 #include "engine/state_machine.hpp"
 #include "engine/evaluator.hpp"
 #include "search/threaded_search.hpp"
+#include "search/lazy_smp_search.hpp"
 #include "search/iterative_search.hpp"
 #include "search/transposition_search.hpp"
 #include "search/search.hpp"
+#include "search/make_unmake_search.hpp"
+#include "search/time_manager.hpp"
 #include "string_functions.hpp"
 #include <iostream>
 #include <chrono>
+#include <type_traits>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <thread>
+#include <ctime>
+#include <algorithm>
 
 namespace {
     constexpr unsigned int max_shallow_depth = parameters::MAX_SHALLOW_DEPTH;
     constexpr unsigned int max_deep_depth = 6;
+
+    // counts every request to the global allocator
+    std::atomic<std::size_t> allocation_count{0};
+
+    engine::State getPerformanceState() {
+        engine::State start_state;
+        start_state.shotgun.load(4, 4);
+        start_state.resetLives(4);
+        start_state.player.items = {engine::Item::Beer, engine::Item::Glass, engine::Item::Phone, engine::Item::Saw,
+                                    engine::Item::Inverter, engine::Item::Pills, engine::Item::Cigarette, engine::Item::Adrenalin};
+        start_state.dealer.items = {engine::Item::Handcuffs, engine::Item::Glass, engine::Item::Phone, engine::Item::Saw,
+                                    engine::Item::Inverter, engine::Item::Pills, engine::Item::Cigarette, engine::Item::Adrenalin};
+        return start_state;
+    }
+}
+
+// memory of the replaced operators comes from malloc, the compiler only sees new and free once they are inlined
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void* operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if(void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
 }
+#pragma GCC diagnostic pop
 
 template <typename Solver>
 void run_test(unsigned int max_shallow_depth, unsigned int max_deep_depth, const engine::State& start_state) {
     Solver solver;
+    const std::size_t allocations_before = allocation_count.load();
     auto start = std::chrono::high_resolution_clock::now();
     const auto result = solver.expectiminimax(start_state, max_shallow_depth, max_deep_depth);
     auto end = std::chrono::high_resolution_clock::now();
+    const std::size_t allocations = allocation_count.load() - allocations_before;
     const std::chrono::duration<double> elapsed = end - start;
     std::cout << "Time of algorithm execution: " << elapsed.count() << " seconds." << std::endl;
+    std::cout << "Score: " << result.score << "." << std::endl;
+    std::cout << "Visited nodes: " << solver.node_count << " (" << static_cast<double>(solver.node_count) / elapsed.count() << " nodes/s)." << std::endl;
+    std::cout << "Children skipped by pruning: " << solver.skipped_children << "." << std::endl;
+    std::cout << "Global allocations: " << allocations << " (" << static_cast<double>(allocations) / solver.node_count << " per node)." << std::endl;
+    if constexpr (search::has_table_statistics<Solver>::value) {
+        const auto statistics = solver.getTableStatistics();
+        std::cout << "Transposition table: " << statistics.hits << " hits, " << statistics.misses << " misses, "
+                  << statistics.overwrites << " overwrites, " << statistics.fill * 100.0 << "% filled." << std::endl;
+    }
 }
 
-TEMPLATE_TEST_CASE("Algorithm Performance Test", "[template]", 
-                   (search::ThreadedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>>),
-                   (search::ExtendedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>>),
-                   (search::ThreadedSearch<search::Search<engine::StateMachine, engine::Evaluator>>),
-                   (search::ExtendedSearch<search::Search<engine::StateMachine, engine::Evaluator>>),
-                   (search::ThreadedSearch<search::IterativeSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>>>),
-                   (search::ExtendedSearch<search::IterativeSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>>>)) {
-
+TEST_CASE("State copy performance test", "[State]") {
+    constexpr std::size_t copies = 10000000;
     engine::State start_state;
     start_state.shotgun.load(4, 4);
     start_state.resetLives(4);
@@ -41,7 +89,183 @@ TEMPLATE_TEST_CASE("Algorithm Performance Test", "[template]",
     start_state.dealer.items = {engine::Item::Handcuffs, engine::Item::Glass, engine::Item::Phone, engine::Item::Saw,
                                 engine::Item::Inverter, engine::Item::Pills, engine::Item::Cigarette, engine::Item::Adrenalin};
 
-    run_test<TestType>(max_shallow_depth, max_deep_depth, start_state);
+    std::size_t remaining_rounds{0};
+    auto start = std::chrono::high_resolution_clock::now();
+    for(std::size_t idx = 0; idx < copies; ++idx) {
+        // copy into the arena like getChildStates does for every child
+        arena::Arena::Scope scope{arena::Arena::local()};
+        engine::State* copy = new (scope.getArena().allocate<engine::State>(1)) engine::State{start_state};
+        copy->probability = static_cast<double>(idx);
+        remaining_rounds += copy->shotgun.getRemainingRounds();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::nano> elapsed = end - start;
+    std::cout << "State size: " << sizeof(engine::State) << " bytes, trivially copyable: " << std::is_trivially_copyable_v<engine::State> << "." << std::endl;
+    std::cout << "Time per state copy: " << elapsed.count() / static_cast<double>(copies) << " nanoseconds." << std::endl;
+    REQUIRE(remaining_rounds == copies * 8);
+}
+
+TEMPLATE_TEST_CASE("Algorithm Performance Test", "[template]", 
+                   (search::ThreadedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>>),
+                   (search::ExtendedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>>),
+                   (search::ThreadedSearch<search::Search<engine::StateMachine, engine::Evaluator>>),
+                   (search::ExtendedSearch<search::Search<engine::StateMachine, engine::Evaluator>>),
+                   (search::ThreadedSearch<search::IterativeSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>>>),
+                   (search::ExtendedSearch<search::IterativeSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>>>),
+                   (search::ThreadedSearch<search::MakeUnmakeSearch<engine::StateMachine, engine::Evaluator>>),
+                   (search::ExtendedSearch<search::MakeUnmakeSearch<engine::StateMachine, engine::Evaluator>>),
+                   (search::LazySmpSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>>)) {
+
+    run_test<TestType>(max_shallow_depth, max_deep_depth, getPerformanceState());
+}
+
+TEMPLATE_TEST_CASE("Move ordering performance test", "[ordering]",
+                   (search::ExtendedSearch<search::Search<engine::StateMachine, engine::Evaluator, search::NoMoveOrdering>>),
+                   (search::ExtendedSearch<search::Search<engine::StateMachine, engine::Evaluator, search::MoveOrdering<true, false>>>),
+                   (search::ExtendedSearch<search::Search<engine::StateMachine, engine::Evaluator, search::MoveOrdering<false, true>>>),
+                   (search::ExtendedSearch<search::Search<engine::StateMachine, engine::Evaluator, search::MoveOrdering<true, true>>>),
+                   (search::ExtendedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::NoMoveOrdering>>),
+                   (search::ExtendedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::MoveOrdering<false, false, true>>>),
+                   (search::ExtendedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::MoveOrdering<true, true>>>),
+                   (search::ExtendedSearch<search::IterativeSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::NoMoveOrdering>>>),
+                   (search::ExtendedSearch<search::IterativeSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::MoveOrdering<false, false, true>>>>),
+                   (search::ThreadedSearch<search::IterativeSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::NoMoveOrdering>>>),
+                   (search::ThreadedSearch<search::IterativeSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::MoveOrdering<false, false, true>>>>)) {
+
+    run_test<TestType>(max_shallow_depth, max_deep_depth, getPerformanceState());
+}
+
+TEMPLATE_TEST_CASE("Chance pruning performance test", "[chance]",
+                   (search::ExtendedSearch<search::Search<engine::StateMachine, engine::Evaluator, search::MoveOrdering<>, search::ChancePruning::None>>),
+                   (search::ExtendedSearch<search::Search<engine::StateMachine, engine::Evaluator, search::MoveOrdering<>, search::ChancePruning::Star1>>),
+                   (search::ExtendedSearch<search::Search<engine::StateMachine, engine::Evaluator, search::MoveOrdering<>, search::ChancePruning::Star2>>),
+                   (search::ExtendedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::MoveOrdering<>, search::ChancePruning::None>>),
+                   (search::ExtendedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::MoveOrdering<>, search::ChancePruning::Star1>>),
+                   (search::ExtendedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::MoveOrdering<>, search::ChancePruning::Star2>>),
+                   (search::ExtendedSearch<search::Search<engine::StateMachine, engine::Evaluator, search::NoMoveOrdering, search::ChancePruning::None>>),
+                   (search::ExtendedSearch<search::Search<engine::StateMachine, engine::Evaluator, search::NoMoveOrdering, search::ChancePruning::Star1>>),
+                   (search::ExtendedSearch<search::Search<engine::StateMachine, engine::Evaluator, search::NoMoveOrdering, search::ChancePruning::Star2>>),
+                   (search::ExtendedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::NoMoveOrdering, search::ChancePruning::None>>),
+                   (search::ExtendedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::NoMoveOrdering, search::ChancePruning::Star1>>),
+                   (search::ExtendedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::NoMoveOrdering, search::ChancePruning::Star2>>)) {
+
+    run_test<TestType>(max_shallow_depth, max_deep_depth, getPerformanceState());
+}
+
+TEMPLATE_TEST_CASE("Principal variation search performance test", "[pvs]",
+                   (search::ExtendedSearch<search::Search<engine::StateMachine, engine::Evaluator, search::MoveOrdering<>, search::ChancePruning::Star1, false>>),
+                   (search::ExtendedSearch<search::Search<engine::StateMachine, engine::Evaluator, search::MoveOrdering<>, search::ChancePruning::Star1, true>>),
+                   (search::ExtendedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::MoveOrdering<>, search::ChancePruning::Star1, false>>),
+                   (search::ExtendedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::MoveOrdering<>, search::ChancePruning::Star1, true>>)) {
+
+    run_test<TestType>(max_shallow_depth, max_deep_depth, getPerformanceState());
+}
+
+TEMPLATE_TEST_CASE("Equal time performance test", "[aspiration][pvs]",
+                   (search::IterativeSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>, false>),
+                   (search::IterativeSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>, true>),
+                   (search::IterativeSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::MoveOrdering<>, search::ChancePruning::Star1, true>, false>),
+                   (search::IterativeSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator, search::MoveOrdering<>, search::ChancePruning::Star1, true>, true>)) {
+    // the search that completes the deepest iteration within the same time wins
+    constexpr double time_limit = 1.0;
+    search::SearchLimits limits{time_limit};
+    limits.soft_time_limit = time_limit;
+    const auto state = getPerformanceState();
+    TestType solver;
+    double score;
+    {
+        search::TimeManager time_manager{*solver.getCancellation(), limits};
+        score = solver.expectiminimax(state, engine::StateMachine::getMaxDepth(state));
+    }
+    std::cout << "Depth " << solver.completed_depth << " completed within " << time_limit << " seconds with score " << score
+              << " and " << solver.node_count << " nodes." << std::endl;
+    REQUIRE(solver.completed_depth > 0);
+}
+
+TEMPLATE_TEST_CASE("Thread scaling performance test", "[threads]",
+                   (search::ThreadedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>>),
+                   (search::ThreadedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>, false>),
+                   (search::LazySmpSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>>)) {
+    using Solver = TestType;
+    const unsigned int previous_threads = Solver::free_threads.load();
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << "." << std::endl;
+    for(unsigned int threads = 1; threads <= 32; threads *= 2) {
+        Solver::free_threads.store(threads);
+        Solver solver;
+        const std::clock_t cpu_start = std::clock();
+        auto start = std::chrono::high_resolution_clock::now();
+        solver.expectiminimax(getPerformanceState(), max_shallow_depth, max_deep_depth);
+        auto end = std::chrono::high_resolution_clock::now();
+        const double cpu_time = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+        const std::chrono::duration<double> elapsed = end - start;
+        // share of the usable cores that was busy during the search
+        const unsigned int cores = std::max(1u, std::min(threads, std::thread::hardware_concurrency()));
+        std::cout << threads << " threads: " << solver.node_count << " nodes in " << elapsed.count() << " seconds ("
+                  << static_cast<double>(solver.node_count) / elapsed.count() << " nodes/s, "
+                  << 100.0 * cpu_time / (elapsed.count() * cores) << "% CPU utilisation)." << std::endl;
+        REQUIRE(Solver::free_threads.load() == threads);
+    }
+    Solver::free_threads.store(previous_threads);
+}
+
+TEMPLATE_TEST_CASE("Cancellation latency test", "[cancellation]",
+                   (search::ThreadedSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>>),
+                   (search::ThreadedSearch<search::Search<engine::StateMachine, engine::Evaluator>>),
+                   (search::ThreadedSearch<search::IterativeSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>>>),
+                   (search::ThreadedSearch<search::MakeUnmakeSearch<engine::StateMachine, engine::Evaluator>>),
+                   (search::LazySmpSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>>)) {
+    // the full tree takes far longer than the time limit
+    constexpr double time_limit = 0.1;
+    TestType solver;
+    auto start = std::chrono::high_resolution_clock::now();
+    solver.expectiminimax(getPerformanceState(), max_shallow_depth, engine::StateMachine::getMaxDepth(getPerformanceState()), time_limit);
+    auto end = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double> elapsed = end - start;
+    std::cout << "Search returned " << (elapsed.count() - time_limit) * 1000.0 << " milliseconds after the deadline." << std::endl;
+    REQUIRE(elapsed.count() >= time_limit);
+}
+
+TEST_CASE("Soft deadline test", "[iterative][time]") {
+    using Solver = search::IterativeSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>>;
+    const auto state = getPerformanceState();
+    for(const double time_limit : {0.5, 1.0, 2.0}) {
+        Solver solver;
+        auto start = std::chrono::high_resolution_clock::now();
+        {
+            search::TimeManager time_manager{*solver.getCancellation(), time_limit};
+            solver.expectiminimax(state, engine::StateMachine::getMaxDepth(state));
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        const std::chrono::duration<double> elapsed = end - start;
+        std::cout << "Time limit of " << time_limit << " seconds: depth " << solver.completed_depth << " completed, search returned after "
+                  << elapsed.count() << " seconds." << std::endl;
+        REQUIRE(solver.completed_depth > 0);
+    }
+}
+
+TEST_CASE("Iterative deepening time to depth test", "[iterative]") {
+    using Solver = search::IterativeSearch<search::TranspositionSearch<engine::StateMachine, engine::Evaluator>>;
+    for(unsigned int depth = 1; depth <= max_shallow_depth + max_deep_depth; ++depth) {
+        Solver solver;
+        auto start = std::chrono::high_resolution_clock::now();
+        solver.expectiminimax(getPerformanceState(), depth);
+        auto end = std::chrono::high_resolution_clock::now();
+        const std::chrono::duration<double> elapsed = end - start;
+        std::cout << "Depth " << depth << " reached after " << elapsed.count() << " seconds and " << solver.node_count << " nodes." << std::endl;
+    }
+}
+
+TEST_CASE("Search allocation test", "[template]") {
+    // the arena keeps its blocks, only the first search may need new ones
+    search::ExtendedSearch<search::Search<engine::StateMachine, engine::Evaluator>> warm_up;
+    warm_up.expectiminimax(getPerformanceState(), 4, 2);
+
+    search::ExtendedSearch<search::Search<engine::StateMachine, engine::Evaluator>> solver;
+    const std::size_t allocations_before = allocation_count.load();
+    solver.expectiminimax(getPerformanceState(), 4, 2);
+    const std::size_t allocations = allocation_count.load() - allocations_before;
+    std::cout << "Global allocations of a warm search: " << allocations << " for " << solver.node_count << " nodes." << std::endl;
+    REQUIRE(allocations == 0);
 }
 
 int main(int argc, char* argv[]) {